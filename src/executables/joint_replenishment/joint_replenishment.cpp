@@ -6,6 +6,7 @@
 #include "dynaplex/vargroup.h"
 #include "dynaplex/modelling/discretedist.h"
 #include "dynaplex/retrievestate.h"
+#include "dynaplex/parallel_execute.h"
 #include "dynaplex/models/joint_replenishment/mdp.h"
 
 using namespace DynaPlex;
@@ -213,13 +214,11 @@ int evaluate() {
                         }
 
                         for (int64_t j = 0; j < nrProducts; j++) { // store inventory position level before demand
-                            auto& product = state.SKUs[j];
-
-                            inventoryLevelPrior[j] = product.inventoryLevel;
-                            orderQtyPrior[j] = product.orderQty[0]; // when event is incorporated, we lose this information
+                            inventoryLevelPrior[j] = state.inventoryLevel[j];
+                            orderQtyPrior[j] = state.OrderQty(j, 0); // when event is incorporated, we lose this information
 
                             // create list of number of orders each item is included within
-                            if (product.orderQty[leadTime - 1] != 0) {
+                            if (state.OrderQty(j, leadTime - 1) != 0) {
                                 itemOrders[j] += 1;
                             }
                         }
@@ -231,9 +230,7 @@ int evaluate() {
                         backorderCost += state.periodBackorderCosts;
 
                         for (int64_t j = 0; j < nrProducts; j++) { // derive demand from previous and current inventory levels
-                            auto& product = state.SKUs[j];
-
-                            demand = inventoryLevelPrior[j] - (product.inventoryLevel - orderQtyPrior[j]);
+                            demand = inventoryLevelPrior[j] - (state.inventoryLevel[j] - orderQtyPrior[j]);
                             totalDemand += demand;
 
                             if (demand != 0) {
@@ -245,13 +242,10 @@ int evaluate() {
                                 }
                             }
 
-                            inventoryPosition = product.inventoryLevel;
-                            for (int64_t k = 0; k < leadTime; k++) {
-                                inventoryPosition += product.orderQty[k];
-                            }
+                            inventoryPosition = static_cast<int64_t>(state.InventoryPosition(j));
 
                             inventoryPositionsOverTime[j][i] = inventoryPosition;
-                            inventoryLevelsOverTime[j][i] = product.inventoryLevel;
+                            inventoryLevelsOverTime[j][i] = state.inventoryLevel[j];
                         }
                         i++; // count number of sample periods
                     }
@@ -367,13 +361,11 @@ int evaluate() {
                     }
 
                     for (int64_t j = 0; j < nrProducts; j++) { // store inventory position level before demand
-                        auto& product = state.SKUs[j];
-
-                        inventoryLevelPrior[j] = product.inventoryLevel;
-                        orderQtyPrior[j] = product.orderQty[0]; // when event is incorporated, we lose this information
+                        inventoryLevelPrior[j] = state.inventoryLevel[j];
+                        orderQtyPrior[j] = state.OrderQty(j, 0); // when event is incorporated, we lose this information
 
                         // create list of number of orders each item is included within
-                        if (product.orderQty[leadTime - 1] != 0) {
+                        if (state.OrderQty(j, leadTime - 1) != 0) {
                             itemOrders[j] += 1;
                         }
                     }
@@ -385,9 +377,7 @@ int evaluate() {
                     backorderCost += state.periodBackorderCosts;
 
                     for (int64_t j = 0; j < nrProducts; j++) { // derive demand from previous and current inventory levels
-                        auto& product = state.SKUs[j];
-
-                        demand = inventoryLevelPrior[j] - (product.inventoryLevel - orderQtyPrior[j]);
+                        demand = inventoryLevelPrior[j] - (state.inventoryLevel[j] - orderQtyPrior[j]);
                         totalDemand += demand;
 
                         if (demand != 0) {
@@ -399,13 +389,10 @@ int evaluate() {
                             }
                         }
 
-                        inventoryPosition = product.inventoryLevel;
-                        for (int64_t k = 0; k < leadTime; k++) {
-                            inventoryPosition += product.orderQty[k];
-                        }
+                        inventoryPosition = static_cast<int64_t>(state.InventoryPosition(j));
 
                         inventoryPositionsOverTime[j][i] = inventoryPosition;
-                        inventoryLevelsOverTime[j][i] = product.inventoryLevel;
+                        inventoryLevelsOverTime[j][i] = state.inventoryLevel[j];
                     }
                     i++; // count number of sample periods
                 }
@@ -518,13 +505,11 @@ int evaluate() {
                     }
 
                     for (int64_t j = 0; j < nrProducts; j++) { // store inventory position level before demand
-                        auto& product = state.SKUs[j];
-
-                        inventoryLevelPrior[j] = product.inventoryLevel;
-                        orderQtyPrior[j] = product.orderQty[0]; // when event is incorporated, we lose this information
+                        inventoryLevelPrior[j] = state.inventoryLevel[j];
+                        orderQtyPrior[j] = state.OrderQty(j, 0); // when event is incorporated, we lose this information
 
                         // create list of number of orders each item is included within
-                        if (product.orderQty[leadTime - 1] != 0) {
+                        if (state.OrderQty(j, leadTime - 1) != 0) {
                             itemOrders[j] += 1;
                         }
                     }
@@ -536,9 +521,7 @@ int evaluate() {
                     backorderCost += state.periodBackorderCosts;
 
                     for (int64_t j = 0; j < nrProducts; j++) { // derive demand from previous and current inventory levels
-                        auto& product = state.SKUs[j];
-
-                        demand = inventoryLevelPrior[j] - (product.inventoryLevel - orderQtyPrior[j]);
+                        demand = inventoryLevelPrior[j] - (state.inventoryLevel[j] - orderQtyPrior[j]);
                         totalDemand += demand;
 
                         if (demand != 0) {
@@ -550,13 +533,10 @@ int evaluate() {
                             }
                         }
 
-                        inventoryPosition = product.inventoryLevel;
-                        for (int64_t k = 0; k < leadTime; k++) {
-                            inventoryPosition += product.orderQty[k];
-                        }
+                        inventoryPosition = static_cast<int64_t>(state.InventoryPosition(j));
 
                         inventoryPositionsOverTime[j][i] = inventoryPosition;
-                        inventoryLevelsOverTime[j][i] = product.inventoryLevel;
+                        inventoryLevelsOverTime[j][i] = state.inventoryLevel[j];
                     }
                     i++; // count number of sample periods
                 }
@@ -1102,9 +1082,135 @@ int heatMap() {
     return 0;
 }
 
+// evaluates policies over many trajectories in parallel; KPIs are accumulated by the mdp itself (trackKPIs)
+int evaluateKPIs() {
+    try {
+        auto& dp = DynaPlexProvider::Get();
+        std::string model_name = "joint_replenishment";
+        std::string mdp_config_name = "mdp_config_0.json";
+        std::string file_path = dp.System().filepath("mdp_config_examples", model_name, mdp_config_name);
+        auto mdp_vars_from_json = VarGroup::LoadFromFile(file_path);
+        mdp_vars_from_json.Set("trackKPIs", true);
+        auto mdp = dp.GetMDP(mdp_vars_from_json);
+        using underlying_mdp = DynaPlex::Models::joint_replenishment::MDP;
+
+        double containerVolume;
+        mdp_vars_from_json.Get("capacity", containerVolume);
+
+        int64_t nrTrajectories = 1000;
+        int64_t periodsPerTrajectory = 1040;
+        int64_t rng_seed = 11112014;
+
+        std::vector<std::string> evaluatePolicyList = { "canOrderPolicy", "periodicReviewPolicy" };
+        for (int64_t k = 0; k < evaluatePolicyList.size(); k++) {
+            std::string policy_config_name = "policy_config_" + std::to_string(k) + ".json";
+            std::string policy_file_path = dp.System().filepath("mdp_config_examples", model_name, policy_config_name);
+            auto policy = mdp->GetPolicy(VarGroup::LoadFromFile(policy_file_path));
+
+            std::vector<Trajectory> trajectories;
+            trajectories.reserve(nrTrajectories);
+            for (int64_t i = 0; i < nrTrajectories; i++) {
+                trajectories.emplace_back(i);
+                trajectories.back().RNGProvider.SeedEventStreams(true, rng_seed, i);
+            }
+
+            DynaPlex::Parallel::parallel_compute<Trajectory>(dp.System(), trajectories, [&](std::span<Trajectory> span, int64_t) {
+                mdp->InitiateState(span);
+                mdp->Rollout(span, policy, periodsPerTrajectory);
+                });
+
+            underlying_mdp::KPIs total{};
+            for (auto& traj : trajectories) {
+                total.Add(DynaPlex::RetrieveState<underlying_mdp::State>(traj.GetState()).kpis);
+            }
+
+            double totalDemand = std::accumulate(total.demand.begin(), total.demand.end(), 0.0);
+            double totalDemandMet = std::accumulate(total.demandMet.begin(), total.demandMet.end(), 0.0);
+            double totalItemOrders = static_cast<double>(std::accumulate(total.orderCount.begin(), total.orderCount.end(), int64_t{ 0 }));
+            double periods = static_cast<double>(total.periods);
+            double containers = static_cast<double>(total.containers);
+
+            VarGroup kpis{};
+            kpis.Add("serviceLevel", totalDemandMet / totalDemand);
+            kpis.Add("fillRate", total.usedCapacity / (containers * containerVolume));
+            kpis.Add("periodicity", containers / periods);
+            kpis.Add("backorderCost", total.backorderCosts / periods);
+            kpis.Add("holdingCost", total.holdingCosts / periods);
+            kpis.Add("orderingCost", total.orderingCosts / periods);
+            kpis.Add("totalCost", (total.backorderCosts + total.holdingCosts + total.orderingCosts) / periods);
+            kpis.Add("itemsPerOrder", totalItemOrders / containers);
+            kpis.Add("totals", total.ToVarGroup());
+
+            auto filename = dp.System().filepath("joint_replenishment", "Evaluation", evaluatePolicyList[k] + "_kpis.json");
+            kpis.SaveToFile(filename);
+            std::cout << evaluatePolicyList[k] << ": " << kpis.Dump() << std::endl;
+        }
+    }
+
+    catch (const DynaPlex::Error& e) {
+        std::cout << e.what() << std::endl;
+    }
+
+    return 0;
+}
+
+int optimizeCanOrder() {
+    try {
+        auto& dp = DynaPlexProvider::Get();
+        std::string model_name = "joint_replenishment";
+        std::string mdp_config_name = "mdp_config_0.json";
+        std::string file_path = dp.System().filepath("mdp_config_examples", model_name, mdp_config_name);
+        auto mdp = dp.GetMDP(DynaPlex::VarGroup::LoadFromFile(file_path));
+
+        // start the search from the hand-tuned can-order parameters
+        std::string policy_file_path = dp.System().filepath("mdp_config_examples", model_name, "policy_config_0.json");
+        auto initialPolicy = DynaPlex::VarGroup::LoadFromFile(policy_file_path);
+
+        // candidates are compared on common random numbers; see PolicyComparer for further settings
+        DynaPlex::VarGroup searchConfig{
+            {"number_of_trajectories", 1000},
+            {"periods_per_trajectory", 500},
+            {"initial_step", 4},
+            {"rng_seed", 1122}
+        };
+        auto search = dp.GetParameterSearch(mdp, searchConfig);
+
+        // per SKU, the reorder point may not exceed the can-order point, which may not exceed the order-up-to level
+        auto isFeasible = [](const DynaPlex::VarGroup& policy) {
+            std::vector<int64_t> reorderPoint, canOrderPoint, orderUpToLevel;
+            policy.Get("reorderPoint", reorderPoint);
+            policy.Get("canOrderPoint", canOrderPoint);
+            policy.Get("orderUpToLevel", orderUpToLevel);
+            for (size_t i = 0; i < reorderPoint.size(); i++) {
+                if (reorderPoint[i] > canOrderPoint[i] || canOrderPoint[i] >= orderUpToLevel[i]) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        auto result = search.Optimize(initialPolicy, { "reorderPoint", "canOrderPoint", "orderUpToLevel" }, isFeasible);
+        std::cout << result.Dump() << std::endl;
+
+        // the optimized policy is a stronger benchmark, and a better initial policy for DCL than "random"
+        DynaPlex::VarGroup bestPolicy;
+        result.Get("policy", bestPolicy);
+        auto filename = dp.System().filepath("joint_replenishment", "Evaluation", "optimized_can_order.json");
+        bestPolicy.SaveToFile(filename);
+    }
+
+    catch (const DynaPlex::Error& e) {
+        std::cout << e.what() << std::endl;
+    }
+
+    return 0;
+}
+
 int main() {
 
     // train();
     evaluate();
     // heatMap();
+    // optimizeCanOrder();
+    // evaluateKPIs();
 };
\ No newline at end of file
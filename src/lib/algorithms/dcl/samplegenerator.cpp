@@ -5,8 +5,28 @@
 #include "dynaplex/sample.h"
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
 namespace DynaPlex::DCL {
 
+	namespace {
+		//temporary sample files are gathered over MPI in chunks of at most this many bytes.
+		constexpr uint64_t gather_chunk_size = uint64_t{ 1 } << 24;
+
+		void AppendFileTo(const std::string& source, std::ofstream& target) {
+			std::ifstream file(source, std::ios::binary);
+			if (!file.is_open())
+				throw DynaPlex::Error("SampleGenerator: failed to open file for reading: " + source);
+			//streaming an empty file would set the failbit of target.
+			if (file.peek() != std::ifstream::traits_type::eof())
+				target << file.rdbuf();
+			if (!target)
+				throw DynaPlex::Error("SampleGenerator: failed to append " + source);
+		}
+	}
+
 
 	SampleGenerator::SampleGenerator(const DynaPlex::System& system, DynaPlex::MDP mdp, const VarGroup& config)
 		: system{ system }, mdp{ mdp }, node_sampling_offset{}
@@ -30,6 +50,16 @@ namespace DynaPlex::DCL {
 
 
 		config.GetOrDefault("json_save_format", json_save_format, -1);
+		config.GetOrDefault("sample_file_format", sample_file_format, "json");
+		if (sample_file_format != "json" && sample_file_format != "binary")
+			throw DynaPlex::Error("SampleGenerator :: Invalid sample_file_format \"" + sample_file_format + "\" - should be \"json\" or \"binary\"");
+		config.GetOrDefault("stream_samples", stream_samples, false);
+		if (stream_samples && sample_file_format != "binary")
+			throw DynaPlex::Error("SampleGenerator :: stream_samples requires sample_file_format \"binary\"");
+		config.GetOrDefault("shard_buffer_size", shard_buffer_size, 1024);
+		config.GetOrDefault("gather_samples_with_mpi", gather_samples_with_mpi, true);
+		if (shard_buffer_size < 1)
+			throw DynaPlex::Error("SampleGenerator :: Invalid shard_buffer_size - should be positive");
 		config.GetOrDefault("rng_seed", rng_seed, 15112017);
 		if (rng_seed < 0)
 			throw DynaPlex::Error("SampleGenerator :: Invalid rng_seed - should be non-negative");
@@ -48,7 +78,7 @@ namespace DynaPlex::DCL {
 		seed_offset = 0;
 	}
 
-	void SampleGenerator::GenerateSamplesOnThread(std::span<DynaPlex::NN::Sample> somesamples, DynaPlex::Policy policy, int64_t thread_offset)
+	void SampleGenerator::GenerateSamplesOnThread(std::span<DynaPlex::NN::Sample> buffer, int64_t num_samples, DynaPlex::Policy policy, int64_t thread_offset, const SampleFlush& flush)
 	{
 		bool use_seed_offset = true; // setting it true will secure different seeding between generations 
 		int64_t seed = use_seed_offset ? seed_offset : 0;
@@ -59,7 +89,7 @@ namespace DynaPlex::DCL {
 		DynaPlex::RNG rng(false, rng_seed, offset);
 
 		bool final_reached_once = false;
-		while (num_samples_added < somesamples.size())
+		while (num_samples_added < num_samples)
 		{
 			mdp->InitiateState({ &trajectory,1 });
 
@@ -98,7 +128,7 @@ namespace DynaPlex::DCL {
 					else {
 						if (rng.genUniform() < sampling_probability)
 						{
-							auto& sample = somesamples[num_samples_added];
+							auto& sample = buffer[num_samples_added % buffer.size()];
 							if (enable_sequential_halving && (M > std::ceil(std::log(allowed.size()) / std::log(2)))) {
 								sequentialhalving_action_selector.SetAction(trajectory, sample, offset + num_samples_added);
 							}
@@ -110,7 +140,14 @@ namespace DynaPlex::DCL {
 							{
 								(*total_samples_collected.get())++;
 							}
-							if (++num_samples_added == somesamples.size())
+							num_samples_added++;
+							if (flush)
+							{//hand over the buffer when it is full, or when the last sample is added.
+								size_t buffered = (num_samples_added - 1) % buffer.size() + 1;
+								if (buffered == buffer.size() || num_samples_added == num_samples)
+									flush(buffer.first(buffered));
+							}
+							if (num_samples_added == num_samples)
 								break;//the while(!final_reached) loop, to eventually stop executution. 
 						}
 						else
@@ -144,17 +181,30 @@ namespace DynaPlex::DCL {
 	std::string SampleGenerator::GetPathOfTempSampleFile(int rank)
 	{
 		std::string filename = "samples_node";
-		filename += std::to_string(rank) + ".json";
+		filename += std::to_string(rank) + SampleFileExtension();
 		return system.filepath(mdp->Identifier(), "temp", filename);
 	}
 
+	std::string SampleGenerator::SampleFileExtension() const
+	{
+		return sample_file_format == "binary" ? ".bin" : ".json";
+	}
+
+	void SampleGenerator::SaveSampleData(DynaPlex::NN::SampleData& sample_data, const std::string& path, bool silent_save) const
+	{
+		if (sample_file_format == "binary")
+			sample_data.SaveToBinaryFile(mdp, path, silent_save);
+		else
+			sample_data.SaveToFile(mdp, path, json_save_format, silent_save);
+	}
+
 
 	void SampleGenerator::GenerateSamples(DynaPlex::Policy policy, const std::string& path) {
 
 		if (!policy)
 			policy = mdp->GetPolicy("random");
 
-		auto temp_path = system.filepath(mdp->Identifier(), "temp", "samples_complete.json");
+		auto temp_path = system.filepath(mdp->Identifier(), "temp", "samples_complete" + SampleFileExtension());
 		GenerateStateSamples(policy, temp_path);
 		//Convert to samples that store features instead of the original states.
 		if (system.WorldRank() == 0)
@@ -176,24 +226,145 @@ namespace DynaPlex::DCL {
 
 
 
+	bool SampleGenerator::GatherSamples(DynaPlex::NN::SampleData& sample_data)
+	{
+		if (system.WorldSize() == 1 || !gather_samples_with_mpi || !system.SupportsGather())
+			return false;
+		std::vector<uint8_t> bytes;
+		if (system.WorldRank() > 0)
+			bytes = sample_data.ToBinary(mdp);
+		std::vector<std::vector<uint8_t>> gathered;
+		if (!system.Gather(bytes, gathered))
+			return false;
+		if (system.WorldRank() == 0)
+		{
+			sample_data.Samples.reserve(N);
+			for (size_t rank = 1; rank < gathered.size(); rank++)
+				sample_data.AddFromBinary(mdp, gathered[rank]);
+		}
+		return true;
+	}
+
+	int64_t SampleGenerator::SampleChunkSize(int64_t to_collect_on_node) const
+	{
+		int64_t num_threads = static_cast<int64_t>(system.Pool().NumThreads());
+		return std::max<int64_t>(1, (to_collect_on_node + num_threads - 1) / num_threads);
+	}
+
+	bool SampleGenerator::GatherTempSampleFiles(const std::string& path)
+	{
+		if (system.WorldSize() == 1 || !gather_samples_with_mpi || !system.SupportsGather())
+			return false;
+		auto node_path = GetPathOfTempSampleFile(system.WorldRank());
+		uint64_t size = std::filesystem::file_size(node_path);
+		std::vector<uint8_t> bytes(sizeof(size));
+		std::memcpy(bytes.data(), &size, sizeof(size));
+		std::vector<std::vector<uint8_t>> gathered;
+		//if gathering fails, the temp files are kept for the fallback via the filesystem.
+		if (!system.AllGather(bytes, gathered))
+			return false;
+		std::vector<uint64_t> sizes(gathered.size());
+		for (size_t rank = 0; rank < gathered.size(); rank++)
+			std::memcpy(&sizes[rank], gathered[rank].data(), sizeof(uint64_t));
+
+		std::ofstream file;
+		std::ifstream node_file;
+		if (system.WorldRank() == 0)
+		{
+			file.open(path, std::ios::binary);
+			if (!file.is_open())
+				throw DynaPlex::Error("SampleGenerator: failed to open file for writing: " + path);
+			AppendFileTo(node_path, file);
+		}
+		else
+			node_file.open(node_path, std::ios::binary);
+		//one rank at a time sends its file in bounded chunks, such that memory use does not grow with the number of samples.
+		for (size_t rank = 1; rank < sizes.size(); rank++)
+		{
+			for (uint64_t sent = 0; sent < sizes[rank]; sent += gather_chunk_size)
+			{
+				bytes.clear();
+				if (system.WorldRank() == rank)
+				{
+					bytes.resize(std::min(gather_chunk_size, sizes[rank] - sent));
+					node_file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+					if (!node_file)
+						throw DynaPlex::Error("SampleGenerator: failed to read " + node_path);
+				}
+				if (!system.Gather(bytes, gathered))
+					throw DynaPlex::Error("SampleGenerator: failed to gather temporary sample files over MPI.");
+				if (system.WorldRank() == 0)
+					file.write(reinterpret_cast<const char*>(gathered[rank].data()), static_cast<std::streamsize>(gathered[rank].size()));
+			}
+		}
+		if (system.WorldRank() == 0 && !file)
+			throw DynaPlex::Error("SampleGenerator: failed to write to file: " + path);
+		node_file.close();
+		system.remove_file(node_path);
+		return true;
+	}
+
+	void SampleGenerator::StreamSamplesToShards(DynaPlex::Policy policy, int64_t to_collect_on_node, const DynaPlex::Parallel::ProgressReporter& reporter)
+	{
+		auto node_path = GetPathOfTempSampleFile(system.WorldRank());
+		if (to_collect_on_node == 0)
+		{
+			std::ofstream file(node_path, std::ios::binary);
+			return;
+		}
+		auto& pool = system.Pool();
+		//same chunks as the in-memory collection, such that the collected samples do not depend on stream_samples.
+		auto chunks = DynaPlex::Parallel::get_chunks(to_collect_on_node, SampleChunkSize(to_collect_on_node));
+		std::vector<std::string> shard_paths;
+		for (size_t chunk = 0; chunk < chunks.size(); chunk++)
+			shard_paths.push_back(system.filepath(mdp->Identifier(), "temp", "samples_node" + std::to_string(system.WorldRank()) + "_shard" + std::to_string(chunk) + ".bin"));
+
+		pool.Run(static_cast<int64_t>(chunks.size()), [&](int64_t chunk) {
+			auto [start, end] = chunks[chunk];
+			std::vector<DynaPlex::NN::Sample> buffer(std::min(end - start, shard_buffer_size));
+			bool append = false;
+			int64_t old_number = -1;
+			auto flush = [&](std::span<DynaPlex::NN::Sample> samples) {
+				DynaPlex::NN::SampleData shard{ mdp };
+				shard.Samples.reserve(samples.size());
+				for (auto& sample : samples)
+				{
+					if (sample.sample_number <= old_number)
+						throw DynaPlex::Error("Logical error in SampleGenerator: Sample numbers are not strictly increasing.");
+					old_number = sample.sample_number;
+					shard.Samples.push_back(std::move(sample));
+					sample = DynaPlex::NN::Sample{};
+				}
+				shard.SaveToBinaryFile(mdp, shard_paths[chunk], true, append);
+				append = true;
+				};
+			GenerateSamplesOnThread(buffer, end - start, policy, start, flush);
+			}, reporter);
+
+		//shards are concatenated in the order of the chunks, so sample numbers remain increasing.
+		std::ofstream file(node_path, std::ios::binary);
+		if (!file.is_open())
+			throw DynaPlex::Error("SampleGenerator: failed to open file for writing: " + node_path);
+		for (auto& shard_path : shard_paths)
+		{
+			AppendFileTo(shard_path, file);
+			system.remove_file(shard_path);
+		}
+	}
+
 	void SampleGenerator::GenerateStateSamples(DynaPlex::Policy policy, const std::string& path)
 	{
 		if (!silent)
 			system << "Generating " << N << " samples based on policy type: " << policy->TypeIdentifier() << std::endl;
 
-		uniform_action_selector = DynaPlex::DCL::UniformActionSelector(rng_seed, H, M, mdp, policy);
-		sequentialhalving_action_selector = DynaPlex::DCL::SequentialHalving(rng_seed, H, M, mdp, policy);
+		uniform_action_selector = DynaPlex::DCL::UniformActionSelector(system, rng_seed, H, M, mdp, policy);
+		sequentialhalving_action_selector = DynaPlex::DCL::SequentialHalving(system, rng_seed, H, M, mdp, policy);
 		//Get the samples that must be collected for this specific node 
 		auto splits = DynaPlex::Parallel::get_splits(N, system.WorldSize());
 		auto& [start_for_node, end_for_node] = splits[system.WorldRank()];
 
 		node_sampling_offset = start_for_node;
 		int64_t to_collect_on_node = end_for_node - start_for_node;
-		//Create space for the samples collected on this node, and collect the samples:
-		std::vector<DynaPlex::NN::Sample> sample_vec(to_collect_on_node);
-		auto work = [this, &policy](std::span<DynaPlex::NN::Sample> somesamples, int64_t thread_offset) {
-			this->GenerateSamplesOnThread(somesamples, policy, thread_offset); };
-
 
 		//for reporting progress:
 		DynaPlex::Parallel::ProgressReporter reporter;
@@ -243,7 +414,35 @@ namespace DynaPlex::DCL {
 			}
 		}
 
-		DynaPlex::Parallel::parallel_compute<DynaPlex::NN::Sample>(sample_vec, work, system.HardwareThreads(), reporter);
+		if (stream_samples)
+		{
+			StreamSamplesToShards(policy, to_collect_on_node, reporter);
+			seed_offset += N;
+			if (!GatherTempSampleFiles(path))
+			{
+				//wait until all nodes have written their samples.
+				system.AddBarrier();
+				if (system.WorldRank() == 0)
+				{//binary sample files can be merged by concatenation, without loading any states.
+					std::ofstream file(path, std::ios::binary);
+					if (!file.is_open())
+						throw DynaPlex::Error("SampleGenerator: failed to open file for writing: " + path);
+					for (size_t rank = 0; rank < system.WorldSize(); rank++)
+					{
+						AppendFileTo(GetPathOfTempSampleFile(rank), file);
+						system.remove_file(GetPathOfTempSampleFile(rank));
+					}
+				}
+			}
+			system.AddBarrier();
+			return;
+		}
+
+		//Create space for the samples collected on this node, and collect the samples:
+		std::vector<DynaPlex::NN::Sample> sample_vec(to_collect_on_node);
+		auto work = [this, &policy](std::span<DynaPlex::NN::Sample> somesamples, int64_t thread_offset) {
+			this->GenerateSamplesOnThread(somesamples, static_cast<int64_t>(somesamples.size()), policy, thread_offset); };
+		DynaPlex::Parallel::parallel_compute<DynaPlex::NN::Sample>(system, sample_vec, work, reporter, SampleChunkSize(to_collect_on_node));
 		seed_offset += N;
 
 		//gather all the collected samples over the threads into sample_data.
@@ -263,23 +462,31 @@ namespace DynaPlex::DCL {
 			old_number = sample.sample_number;
 		}
 
-		//nodes other than 0 save their samples
-		if (system.WorldRank() > 0)
-			sample_data.SaveToFile(mdp, GetPathOfTempSampleFile(system.WorldRank()));
-		//wait until saving on all nodes completes. 
-		system.AddBarrier();
-		//load the collected samples by this and other nodes, and save the combined samples.
-		if (system.WorldRank() == 0)
-		{//let node 0 do the gathering and saving.
-			sample_data.Samples.reserve(N);
-			for (size_t rank = 1; rank < system.WorldSize(); rank++)
-			{
-				sample_data.AddFromFile(mdp, GetPathOfTempSampleFile(rank));
-				system.remove_file(GetPathOfTempSampleFile(rank));
+		//without MPI, nodes exchange samples via the filesystem.
+		if (!GatherSamples(sample_data))
+		{
+			//nodes other than 0 save their samples
+			if (system.WorldRank() > 0)
+				SaveSampleData(sample_data, GetPathOfTempSampleFile(system.WorldRank()), true);
+			//wait until saving on all nodes completes. 
+			system.AddBarrier();
+			//load the collected samples by this and other nodes.
+			if (system.WorldRank() == 0)
+			{//let node 0 do the gathering.
+				sample_data.Samples.reserve(N);
+				for (size_t rank = 1; rank < system.WorldSize(); rank++)
+				{
+					sample_data.AddFromFile(mdp, GetPathOfTempSampleFile(rank));
+					system.remove_file(GetPathOfTempSampleFile(rank));
+				}
 			}
+		}
+		//save the combined samples.
+		if (system.WorldRank() == 0)
+		{
 			DynaPlex::RNG rng(false, rng_seed);
 			std::shuffle(sample_data.Samples.begin(), sample_data.Samples.end(), rng.gen());
-			sample_data.SaveToFile(mdp, path, json_save_format, silent);
+			SaveSampleData(sample_data, path, silent);
 		}
 		system.AddBarrier();
 	}
@@ -1,7 +1,9 @@
 #include "dynaplex/sequentialhalving.h"
 #include "dynaplex/trajectory.h"
+#include "dynaplex/statepool.h"
 #include "dynaplex/parallel_execute.h"
 #include "dynaplex/policycomparison.h"
+#include <algorithm>
 #include <cmath>
 namespace DynaPlex::DCL {
 
@@ -12,15 +14,15 @@ namespace DynaPlex::DCL {
 		int64_t experiment_number;
 	};
 
-	SequentialHalving::SequentialHalving(int64_t rng_seed, int64_t H, int64_t M, DynaPlex::MDP& mdp, DynaPlex::Policy& policy)
-		: rng_seed{ rng_seed }, H{ H }, M{ M }, mdp{ mdp }, policy{ policy }
+	SequentialHalving::SequentialHalving(const DynaPlex::System& system, int64_t rng_seed, int64_t H, int64_t M, DynaPlex::MDP& mdp, DynaPlex::Policy& policy)
+		: system{ system }, rng_seed{ rng_seed }, H{ H }, M{ M }, mdp{ mdp }, policy{ policy }
 	{
 
 	}
 
 	bool adopt_crn_sh = true;
 	int64_t max_chunk_size_sh = 256;
-	int64_t max_steps_until_completion_expected_sh = 1000000;
+	int64_t min_chunk_size_sh = 32;
 	void SequentialHalving::SetAction(DynaPlex::Trajectory& traj, DynaPlex::NN::Sample& sample, int64_t seed) const
 	{
 		if (!traj.Category.IsAwaitAction())
@@ -84,37 +86,21 @@ namespace DynaPlex::DCL {
 			seed_keeper += experiment_information.size(); 
 
 			//iterate over chunks of the trajectories list, and process those for H steps or until final state. 
-			auto chunks = DynaPlex::Parallel::get_chunks(trajectories.size(), max_chunk_size_sh);
-			for (auto& [start, end] : chunks)
+			//chunks are tasks on the thread pool, such that cores that are idle at the sample level can process them.
+			auto& pool = system.Pool();
+			int64_t chunk_size = std::clamp<int64_t>(trajectories.size() / pool.NumThreads(), min_chunk_size_sh, max_chunk_size_sh);
+			auto chunks = DynaPlex::Parallel::get_chunks(trajectories.size(), chunk_size);
+			pool.Run(chunks.size(), [&](int64_t chunk)
 			{
+				auto [start, end] = chunks[chunk];
 				std::span<DynaPlex::Trajectory> span(&trajectories[start], end - start);
+				//states of finished rollouts, reused by the next chunk or sample on the same thread.
+				auto& state_pool = DynaPlex::StatePool::ForThread(mdp);
+				state_pool.Lend(span);
 				mdp->InitiateState(span, root_state);
 				mdp->IncorporateAction(span);
-				int64_t count = 0;
-				while (true)
-				{
-					if (!mdp->IncorporateUntilAction(span, H))
-					{
-						//This "sorts" the trajectories, such that the trajectories that are IsAwaitAction are at the front.
-						// Note that mdp->IncorporateAction only accepts set of adjacent trajectories that are all AwaitAction. 
-						std::span<DynaPlex::Trajectory>::iterator new_partition_point = std::partition(span.begin(), span.end(),
-							[](const DynaPlex::Trajectory& traj) {return traj.Category.IsAwaitAction(); }
-						);
-						//new_partition_point is the first element which does not require an action. 
-						//Make the span refer to a set of trajectories each awaiting an action:
-						span = std::span<DynaPlex::Trajectory>(span.begin(), new_partition_point);
-						if (++count > max_steps_until_completion_expected_sh)
-							throw DynaPlex::Error("SequentialHalving::SetAction"
-								"- expected completion of simulation run after max_steps_until_completion_expected: "
-								+ std::to_string(max_steps_until_completion_expected_sh) +
-								" but completion was not reached.");
-					}
-					//This means all trajectories are at period warmup_periods or final. 
-					if (span.size() == 0)
-						break;
-					//other actions use roll-out policy.
-					mdp->IncorporateAction(span, policy);
-				}
+				//other actions use roll-out policy.
+				mdp->Rollout(span, policy, H);
 				//reset span to original
 				span = { &trajectories[start], static_cast<size_t>(end - start) };
 				//some checks:
@@ -134,10 +120,9 @@ namespace DynaPlex::DCL {
 						if (!(traj.Category.IsFinal() || traj.PeriodCount == H))
 							throw DynaPlex::Error("SequentialHalving::SetAction - unexpected trajectory status after rollout");
 				}
-				//freeing resources
-				for (auto& traj : span)
-					traj.DeleteState();
-			}
+				//freeing resources, by returning them to the pool
+				state_pool.Return(span);
+			});
 
 			std::vector<std::vector<double>> return_results(competing_actions.size(), std::vector<double>(action_budget, 0.0));
 			//A vector of tokens keeping track of the indices of competing_actions in the original root_actions
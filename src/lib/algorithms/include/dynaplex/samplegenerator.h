@@ -5,6 +5,9 @@
 #include "dynaplex/vargroup.h"
 #include "dynaplex/uniformactionselector.h"
 #include "dynaplex/sequentialhalving.h"
+#include "dynaplex/sampledata.h"
+#include "dynaplex/parallel_execute.h"
+#include <functional>
 
 namespace DynaPlex::DCL {
 	class SampleGenerator
@@ -14,24 +17,48 @@ namespace DynaPlex::DCL {
 
 		/// This generates samples and stores the features alognside the collected information.  
 		void GenerateSamples(DynaPlex::Policy,const std::string& file_path);
-		/// This generates samples and stores the state alongside the collected information 
+		/**
+		 * This generates samples and stores the state alongside the collected information.
+		 * With stream_samples, each chunk of work appends its samples to a binary shard every shard_buffer_size samples,
+		 * and shards are merged by concatenation, such that memory use does not grow with N. The samples in the
+		 * resulting file are then ordered by sample number instead of shuffled; PolicyTrainer shuffles them when loading.
+		 * On multiple nodes, node 0 gathers the samples over MPI (gather_samples_with_mpi, default true), and falls back
+		 * to temporary files in the IO directory if MPI is not available.
+		 */
 		void GenerateStateSamples(DynaPlex::Policy,const std::string& file_path);
 
 	private:
 
 		std::string GetPathOfTempSampleFile(int rank);
+		std::string SampleFileExtension() const;
+		/// saves in the format set by sample_file_format ("json" or "binary").
+		void SaveSampleData(DynaPlex::NN::SampleData&, const std::string& path, bool silent_save) const;
 
-		void GenerateSamplesOnThread(std::span<DynaPlex::NN::Sample>, DynaPlex::Policy, int64_t);
+		using SampleFlush = std::function<void(std::span<DynaPlex::NN::Sample>)>;
+		/// collects num_samples samples into buffer; if flush is provided, it is called whenever the buffer is full and for the last samples.
+		void GenerateSamplesOnThread(std::span<DynaPlex::NN::Sample> buffer, int64_t num_samples, DynaPlex::Policy, int64_t thread_offset, const SampleFlush& flush = nullptr);
+		/**
+		 * Samples per chunk of work: one chunk per thread, as before the thread pool. Each chunk starts its own trajectory with
+		 * a warm-up of L periods, so smaller chunks would add warm-ups and change the distribution of the sampled states.
+		 */
+		int64_t SampleChunkSize(int64_t to_collect_on_node) const;
+		/// collective: gathers the samples of all nodes on node 0 over MPI; returns false if the filesystem must be used instead.
+		bool GatherSamples(DynaPlex::NN::SampleData&);
+		/// collective: concatenates the temporary sample files of all nodes into path over MPI, sending them in bounded chunks; returns false if not possible.
+		bool GatherTempSampleFiles(const std::string& path);
+		/// collects the samples of this node into the temporary sample file of the node, via per-chunk shards.
+		void StreamSamplesToShards(DynaPlex::Policy, int64_t to_collect_on_node, const DynaPlex::Parallel::ProgressReporter&);
 
 		//for a progress count when generating samples accross threads. 
 		std::shared_ptr<std::atomic<int64_t>> total_samples_collected;
 
 		int64_t rng_seed;
 		int64_t node_sampling_offset;
-		int64_t sampling_time_out, H, M, N, L, reinitiate_counter, json_save_format;
+		int64_t sampling_time_out, H, M, N, L, reinitiate_counter, json_save_format, shard_buffer_size;
 		int64_t seed_offset;
+		std::string sample_file_format;
 
-		bool enable_sequential_halving,silent;
+		bool enable_sequential_halving, silent, stream_samples, gather_samples_with_mpi;
 		//probability that a sample is taken on a specific action-awaiting state. 
 		double sampling_probability;
 
@@ -18,7 +18,8 @@ namespace DynaPlex::DCL {
 
 	public:
 		SequentialHalving() = default;
-		SequentialHalving(int64_t rng_seed, int64_t H, int64_t M, DynaPlex::MDP&, DynaPlex::Policy&);
+		/// rollouts are executed as tasks on system.Pool(), such that they share cores with the caller if the caller runs on the same pool.
+		SequentialHalving(const DynaPlex::System& system, int64_t rng_seed, int64_t H, int64_t M, DynaPlex::MDP&, DynaPlex::Policy&);
 
 		void SetAction(DynaPlex::Trajectory& traj, DynaPlex::NN::Sample& sample, int64_t seed) const;
 
@@ -26,6 +27,7 @@ namespace DynaPlex::DCL {
 
 
 	private:
+		DynaPlex::System system;
 		int64_t rng_seed;
 		int64_t H, M;
 		DynaPlex::Policy policy;
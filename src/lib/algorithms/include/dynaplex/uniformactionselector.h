@@ -11,7 +11,8 @@ namespace DynaPlex::DCL {
 	
 	public:
 		UniformActionSelector() = default;
-		UniformActionSelector(int64_t rng_seed, int64_t H, int64_t M, DynaPlex::MDP&, DynaPlex::Policy&);
+		/// rollouts are executed as tasks on system.Pool(), such that they share cores with the caller if the caller runs on the same pool.
+		UniformActionSelector(const DynaPlex::System& system, int64_t rng_seed, int64_t H, int64_t M, DynaPlex::MDP&, DynaPlex::Policy&);
 
 		void SetAction(DynaPlex::Trajectory& traj, DynaPlex::NN::Sample& sample, int64_t seed) const;
 
@@ -19,6 +20,7 @@ namespace DynaPlex::DCL {
 	
 
 	private:
+		DynaPlex::System system;
 		int64_t rng_seed;
 		int64_t H, M;
 		DynaPlex::Policy policy;
@@ -0,0 +1,94 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "error.h"
+
+namespace DynaPlex {
+	//Completely in header to support inlining this.
+	/**
+	 * Bitset over the actions [0,Size()) of an MDP, used by MDPs that implement
+	 * GetAllowedActions(const State&, DynaPlex::ActionMask&) const to mark all allowed actions in a single pass.
+	 * Masks of up to 256 actions do not allocate.
+	 */
+	class ActionMask {
+	private:
+		static constexpr int64_t bits_per_word = 64;
+		static constexpr size_t inline_words = 4;
+
+		int64_t size;
+		std::array<uint64_t, inline_words> inline_storage;
+		std::vector<uint64_t> heap_storage;
+
+		uint64_t* Words() {
+			return heap_storage.empty() ? inline_storage.data() : heap_storage.data();
+		}
+		const uint64_t* Words() const {
+			return heap_storage.empty() ? inline_storage.data() : heap_storage.data();
+		}
+		size_t NumWords() const {
+			return static_cast<size_t>((size + bits_per_word - 1) / bits_per_word);
+		}
+
+	public:
+		ActionMask() : size{ 0 }, inline_storage{}, heap_storage{} {}
+		explicit ActionMask(int64_t num_actions) : ActionMask() {
+			Reset(num_actions);
+		}
+
+		/// resizes the mask to num_actions, and marks all actions as not allowed.
+		void Reset(int64_t num_actions) {
+			if (num_actions < 0)
+				throw DynaPlex::Error("ActionMask: number of actions must be non-negative");
+			size = num_actions;
+			inline_storage.fill(0);
+			if (NumWords() > inline_words)
+				heap_storage.assign(NumWords(), 0);
+			else
+				heap_storage.clear();
+		}
+
+		int64_t Size() const {
+			return size;
+		}
+
+		/// marks action as allowed.
+		void Allow(int64_t action) {
+			if (action < 0 || action >= size)
+				throw DynaPlex::Error("ActionMask: action " + std::to_string(action) + " out of range [0," + std::to_string(size) + ")");
+			Words()[action / bits_per_word] |= uint64_t{ 1 } << (action % bits_per_word);
+		}
+
+		bool IsAllowed(int64_t action) const {
+			return (Words()[action / bits_per_word] >> (action % bits_per_word)) & uint64_t{ 1 };
+		}
+
+		/// number of allowed actions.
+		int64_t Count() const {
+			int64_t count = 0;
+			const uint64_t* words = Words();
+			for (size_t i = 0; i < NumWords(); i++)
+				count += std::popcount(words[i]);
+			return count;
+		}
+
+		/// first allowed action that is at least action, or Size() if there is none.
+		int64_t Next(int64_t action) const {
+			if (action >= size)
+				return size;
+			const uint64_t* words = Words();
+			size_t word = static_cast<size_t>(action / bits_per_word);
+			//discard the bits below action in the first word:
+			uint64_t bits = words[word] & (~uint64_t{ 0 } << (action % bits_per_word));
+			while (bits == 0)
+			{
+				if (++word == NumWords())
+					return size;
+				bits = words[word];
+			}
+			return static_cast<int64_t>(word) * bits_per_word + std::countr_zero(bits);
+		}
+	};
+}
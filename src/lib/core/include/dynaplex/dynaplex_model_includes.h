@@ -2,4 +2,5 @@
 #include "dynaplex/rng.h"
 #include "dynaplex/statecategory.h"
 #include "dynaplex/features.h"
+#include "dynaplex/actionmask.h"
 #include "dynaplex/erasure/policyregistry.h"
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 #include <span>
 #include <vector>
+#include <ranges>
+#include <type_traits>
 #include <stdexcept>
 #include "dynaplex/error.h"
 
@@ -35,6 +37,24 @@ namespace DynaPlex {
             index++;
         }
 
+        // Helper function to add a contiguous block of values, checking the bounds once for the whole block
+        template<typename T>
+        void addValues(std::span<const T> values) {
+            if (index + values.size() <= dataSpan.size()) {
+                // plain conversion loop into the buffer, which the compiler vectorizes
+                float* out = dataSpan.data() + index;
+                for (size_t i = 0; i < values.size(); i++) {
+                    out[i] = static_cast<float>(values[i]);
+                }
+                index += values.size();
+            }
+            else {
+                for (const auto& v : values) {
+                    addValue(static_cast<float>(v));
+                }
+            }
+        }
+
     public:
 
         const bool IsFilled() const
@@ -72,34 +92,32 @@ namespace DynaPlex {
         }
 
         template<FloatConvertibleContainer T>
-        void Add(T values) {
-            for (auto& v : values) {
-                Add(v);
+        void Add(const T& values) {
+            using value_type = typename T::value_type;
+            if constexpr (std::ranges::contiguous_range<const T> && std::is_arithmetic_v<value_type>) {
+                addValues(std::span<const value_type>(std::ranges::data(values), std::ranges::size(values)));
+            }
+            else {
+                for (const auto& v : values) {
+                    Add(v);
+                }
             }
         }
 
         void Add(std::span<int64_t> values) {
-            for (auto& v : values) {
-                Add(v);
-            }
+            addValues<int64_t>(values);
         }
 
         void Add(std::span<double> values) {
-            for (auto& v : values) {
-                Add(v);
-            }
+            addValues<double>(values);
         }
 
         void Add(std::span<float> values) {
-            for (auto& v : values) {
-                Add(v);
-            }
+            addValues<float>(values);
         }
 
         void Add(std::span<bool> values) {
-            for (auto& v : values) {
-                Add(v);
-            }
+            addValues<bool>(values);
         }
        
         float& operator[](size_t idx) {
@@ -193,6 +193,15 @@ namespace DynaPlex
 		 */
 		virtual bool IncorporateUntilAction(std::span<DynaPlex::Trajectory> trajectories, int64_t MaxPeriodCount = std::numeric_limits<int64_t>::max()) const = 0;
 
+		/**
+		 * Incorporates events, and actions selected by the policy, in the provided trajectories until each of them is IsFinal(), or
+		 * has trajectory.PeriodCount>=MaxPeriodCount and Category.IsAwaitEvent(). If SkipTrivialActions, actions are only requested
+		 * from the policy if more than a single action is allowed. Equivalent to alternating IncorporateUntilAction (or
+		 * IncorporateUntilNonTrivialAction) and IncorporateAction(trajectories, policy), but for policies obtained from this MDP
+		 * the complete loop runs without virtual calls. The order of the trajectories in the span may change.
+		 */
+		virtual void Rollout(std::span<DynaPlex::Trajectory> trajectories, const DynaPlex::Policy& policy, int64_t MaxPeriodCount = std::numeric_limits<int64_t>::max(), bool SkipTrivialActions = false) const = 0;
+
 
 		/**
 		 * Returns -1.0 or 1.0, depending on whether the mdp objective is minimization of maximization. 
@@ -1,9 +1,13 @@
 #pragma once
-#include <future>
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <span>
-#include <thread>
+#include <tuple>
 #include <vector>
 #include "dynaplex/error.h"
+#include "dynaplex/system.h"
+#include "dynaplex/threadpool.h"
 namespace DynaPlex {
     namespace Parallel {
 
@@ -14,51 +18,33 @@ namespace DynaPlex {
         std::vector<std::tuple<int64_t, int64_t>> get_chunks(size_t total, size_t max_chunk_size);
 
 
+        /**
+         * Calls work(span, offset) for consecutive chunks of output_data, where offset is the index in output_data of the first
+         * element of span. Chunks are executed on system.Pool() and scheduled dynamically, such that chunks that take longer
+         * (e.g. trajectories that reach a final state late) do not leave other threads idle. max_chunk_size defaults to a size that
+         * gives each thread several chunks. If provided, reporter is executed on the calling thread while the work proceeds; its
+         * argument signals that an error occurred. If work throws, remaining chunks are cancelled and the exception is rethrown.
+         */
         template <typename T>
-        void parallel_compute(std::vector<T>& output_data,
-            const std::function<void(std::span<T>, int64_t)>& work, 
-            int64_t num_threads_to_use,
-            const ProgressReporter& reporter = nullptr) {
-
-            if (num_threads_to_use > output_data.size())
-                num_threads_to_use = output_data.size();
-            
-            auto sub_spans_indices = get_splits(output_data.size(), num_threads_to_use);
-
-            std::atomic<bool> error_occurred = false;
-
-            std::vector<std::future<void>> futures;
-            std::vector<std::promise<void>> promises(num_threads_to_use);
-            std::vector<std::jthread> threads;
-
-            for (int64_t ThreadId = 0; ThreadId < num_threads_to_use; ThreadId++) {
-                auto [start, end] = sub_spans_indices[ThreadId];
-                futures.push_back(promises[ThreadId].get_future());
-
-                threads.emplace_back(
-                    [&output_data, &promises, &work, &error_occurred, ThreadId, start, end]() {
-                        try {
-                            auto span = std::span<T>( &output_data[start], end - start );
-                            work(span, start);
-                            promises[ThreadId].set_value();
-                        }
-                        catch (...) {              
-                            promises[ThreadId].set_exception(std::current_exception());
-                            error_occurred = true;
-                        }
-                    }
-                );
-            }
-            if (reporter)
+        void parallel_compute(const DynaPlex::System& system, std::vector<T>& output_data,
+            const std::function<void(std::span<T>, int64_t)>& work,
+            const ProgressReporter& reporter = nullptr,
+            int64_t max_chunk_size = 0) {
+
+            if (output_data.empty())
+                return;
+            auto& pool = system.Pool();
+            if (max_chunk_size <= 0)
             {
-                reporter(error_occurred);
+                constexpr size_t chunks_per_thread = 8;
+                max_chunk_size = std::max<int64_t>(1, output_data.size() / (pool.NumThreads() * chunks_per_thread));
             }
-            // Wait for all futures to complete. If any thread threw an exception, it'll be rethrown here.
-            for (auto& future : futures) {
-                future.get();
-            }
-            // Destroying the threads joins them.
-            threads.clear();
+            auto chunks = get_chunks(output_data.size(), max_chunk_size);
+
+            pool.Run(static_cast<int64_t>(chunks.size()), [&output_data, &work, &chunks](int64_t chunk) {
+                auto [start, end] = chunks[chunk];
+                work(std::span<T>(&output_data[start], end - start), start);
+                }, reporter);
         }
 
 
@@ -0,0 +1,77 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <limits>
+
+namespace DynaPlex {
+	//Completely in header to support inlining this.
+	/**
+	 * Counter-based generator Philox4x32-10 (Salmon et al., 2011), with a 64-bit key and a 64-bit counter.
+	 * The i-th output is a pure function of (key, i), so seeding only mixes the seed into the key, and the generator can
+	 * jump to any position in its stream in constant time. Satisfies UniformRandomBitGenerator.
+	 */
+	class Philox4x32 {
+	public:
+		using result_type = uint64_t;
+		using block_type = std::array<uint32_t, 4>;
+		using key_type = std::array<uint32_t, 2>;
+
+		explicit Philox4x32(uint64_t seed) :
+			key{ static_cast<uint32_t>(MixSeed(seed)), static_cast<uint32_t>(MixSeed(seed) >> 32) }, position{ 0 }, block{}
+		{}
+
+		result_type operator()() {
+			//each block provides two outputs:
+			if (position % 2 == 0)
+				block = Block({ static_cast<uint32_t>(position / 2), static_cast<uint32_t>(position >> 33), 0, 0 }, key);
+			size_t word = 2 * static_cast<size_t>(position % 2);
+			position++;
+			return (static_cast<uint64_t>(block[word + 1]) << 32) | block[word];
+		}
+
+		/// advances the stream by n outputs, in constant time.
+		void discard(uint64_t n) {
+			position += n;
+			if (position % 2 == 1)
+				block = Block({ static_cast<uint32_t>(position / 2), static_cast<uint32_t>(position >> 33), 0, 0 }, key);
+		}
+
+		static constexpr result_type min() {
+			return std::numeric_limits<result_type>::min();
+		}
+		static constexpr result_type max() {
+			return std::numeric_limits<result_type>::max();
+		}
+
+		/// the bijection underlying the generator: encrypts counter with key using ten rounds.
+		static block_type Block(block_type counter, key_type key) {
+			for (int round = 0; round < 10; round++)
+			{
+				uint64_t product0 = static_cast<uint64_t>(0xD2511F53u) * counter[0];
+				uint64_t product1 = static_cast<uint64_t>(0xCD9E8D57u) * counter[2];
+				counter = {
+					static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+					static_cast<uint32_t>(product1),
+					static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+					static_cast<uint32_t>(product0)
+				};
+				key[0] += 0x9E3779B9u;
+				key[1] += 0xBB67AE85u;
+			}
+			return counter;
+		}
+
+	private:
+		//SplitMix64 finalizer; seeds that differ in few bits, as for adjacent streams, get unrelated keys.
+		static constexpr uint64_t MixSeed(uint64_t z) {
+			z += 0x9E3779B97F4A7C15ull;
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			return z ^ (z >> 31);
+		}
+
+		key_type key;
+		uint64_t position;
+		block_type block;
+	};
+}
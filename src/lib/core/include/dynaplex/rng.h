@@ -1,12 +1,19 @@
 #pragma once
+#include <span>
 #include "dynaplex/error.h"
 #include "xoshiro/xoshiro256plusplus.hpp"
+#include "dynaplex/philox.h"
 
 namespace DynaPlex {
 
 	class RNG {
 	public:
+#if DP_COUNTER_BASED_RNG
+		//enabled by the cmake variable dynaplex_counter_based_rng; seeding and Discard take constant time.
+		using type = DynaPlex::Philox4x32;
+#else
 		using type = XoshiroCpp::Xoshiro256PlusPlus;
+#endif
 		/**
 		 * Initiates the random number generator, based on provided parameters: Eval, global_seed, sample, trajectory, stream.
 		 *
@@ -47,6 +54,36 @@ namespace DynaPlex {
 			return XoshiroCpp::DoubleFromBits(generator_());
 		}
 
+		/**
+		 * Fills uniforms with the next uniforms.size() numbers of the stream; the result equals that of
+		 * successive calls to genUniform(). Use this when a number of draws is known in advance.
+		 */
+		void genUniforms(std::span<double> uniforms) {
+			//work on a local copy, such that the generator state stays in registers.
+			type generator = generator_;
+			for (double& uniform : uniforms)
+				uniform = XoshiroCpp::DoubleFromBits(generator());
+			generator_ = generator;
+		}
+
+		/// fills ints with the next ints.size() numbers of the stream; the result equals that of successive calls to genInt().
+		void genInts(std::span<int64_t> ints) {
+			type generator = generator_;
+			for (int64_t& value : ints)
+				value = static_cast<int64_t>(generator());
+			generator_ = generator;
+		}
+
+		/// skips the next n numbers of the stream. Constant time for the counter-based generator, linear in n otherwise.
+		void Discard(uint64_t n) {
+#if DP_COUNTER_BASED_RNG
+			generator_.discard(n);
+#else
+			for (uint64_t i = 0; i < n; i++)
+				generator_();
+#endif
+		}
+
 	private:
 		type generator_;
 		RNG(uint64_t seed);
@@ -1,5 +1,7 @@
 	#pragma once
 	#include <vector>
+	#include <algorithm>
+	#include <optional>
 	#include "rng.h"
 	#include "error.h"
 
@@ -9,22 +11,22 @@
 			///returns the RNG stream for use in policies. 
 			RNG& GetPolicyRNG()
 			{
-				if (rng_vec.empty())
+				if (!seeded)
 					throw DynaPlex::Error("RNGProvider: Attempt to get RNG from empty provider. Did you forget to Seed?");
-				return rng_vec.at(0);
+				return Stream(0);
 			}
 			///returns the RNG stream to be used for getting initial states. 
 			RNG& GetInitiationRNG()
 			{
-				if (rng_vec.empty())
+				if (!seeded)
 					throw DynaPlex::Error("RNGProvider: Attempt to get RNG from empty provider. Did you forget to Seed?");
-				return rng_vec.at(1);
+				return Stream(1);
 			}
 
 			///Returns the rng associated with the a specific event/rng stream 0,1,etc.
 			RNG& GetEventRNG(int64_t number)
 			{			
-				if (rng_vec.empty())
+				if (!seeded)
 					throw DynaPlex::Error("RNGProvider: Attempt to get RNG from empty provider. Did you forget to Seed?");
 			
 				if (number < 0 || number>1000)
@@ -33,28 +35,35 @@
 					//of the seeding strategy. 
 					throw DynaPlex::Error("RNGProvider: eventstream must be non-negative and below 1000");
 
-				Expand(number + 3);
-				return rng_vec.at(number+2);
+				return Stream(static_cast<size_t>(number) + 2);
 			}
 
-			RNGProvider() :rng_vec{}, global_seed{ 0 }, sample{ 0 }, trajectory{ 0 }, eval{ false }
+			RNGProvider() :rng_vec{}, seeded{ false }, eval{ false }, global_seed{ 0 }, sample{ 0 }, trajectory{ 0 }
 			{}
 			
 			
+			///Seeds all streams; each stream is only constructed once it is first requested.
 			void SeedEventStreams(bool evaluation, int64_t rng_seed=13021985, int64_t sample = (1ll << 30)-1, int64_t trajectory = (1ll << 22 ) -1 );
 			
 
 		private:
-			inline void Expand(int64_t size)
+			///returns the stream with the given index, constructing only that stream if it was not yet requested since seeding.
+			inline RNG& Stream(size_t index)
 			{
-				while (rng_vec.size() < size)
+				if (rng_vec.size() <= index)
 				{
-					rng_vec.reserve(size);
-					rng_vec.push_back(DynaPlex::RNG(eval, global_seed, sample, trajectory, rng_vec.size()));
+					//room for the policy, initiation and first event stream, such that references to these remain valid when they are constructed one by one.
+					rng_vec.reserve(std::max<size_t>(index + 1, 3));
+					rng_vec.resize(index + 1);
 				}
+				auto& rng = rng_vec[index];
+				if (!rng)
+					rng.emplace(eval, global_seed, sample, trajectory, static_cast<int64_t>(index));
+				return *rng;
 			}
-			std::vector<DynaPlex::RNG> rng_vec;
+			std::vector<std::optional<DynaPlex::RNG>> rng_vec;
 
+			bool seeded;
 			bool eval;
 			int64_t global_seed, sample, trajectory;
 
@@ -0,0 +1,37 @@
+#pragma once
+#include <span>
+#include <vector>
+#include "state.h"
+#include "trajectory.h"
+#include "mdp.h"
+
+namespace DynaPlex {
+	/**
+	 * Keeps states of finished trajectories, and hands them to new trajectories, such that MDP->InitiateState(trajectories, state)
+	 * can copy into the existing state instead of allocating a clone. Intended for rollouts that repeatedly start many
+	 * trajectories from some root state. Holds at most capacity states; states returned beyond that are released.
+	 * Not thread-safe; use one pool per thread, e.g. via ForThread.
+	 */
+	class StatePool {
+	public:
+		static constexpr size_t default_capacity = 256;
+
+		explicit StatePool(size_t capacity = default_capacity) : capacity{ capacity } {}
+
+		/// gives each trajectory without a state one of the pooled states, as far as available.
+		void Lend(std::span<Trajectory> trajectories);
+		/// takes the states from the trajectories back into the pool, up to capacity; the trajectories are left without state.
+		void Return(std::span<Trajectory> trajectories);
+		/// releases all pooled states.
+		void Clear() { pool.clear(); }
+		/// number of states currently in the pool.
+		size_t Size() const { return pool.size(); }
+
+		/// pool of the calling thread for states of mdp. The pool only holds states of one mdp at a time; it is
+		/// cleared when requested for a different mdp, so that it never keeps states of mdps that are no longer in use.
+		static StatePool& ForThread(const DynaPlex::MDP& mdp);
+	private:
+		std::vector<DynaPlex::dp_State> pool;
+		size_t capacity;
+	};
+}
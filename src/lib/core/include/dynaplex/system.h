@@ -4,16 +4,23 @@
 #include <iostream>  // For std::cout
 #include <string>
 #include <functional>
+#include <vector>
 
 
 namespace DynaPlex {
+    namespace Parallel {
+        class ThreadPool;
+    }
 
     class System {
         friend class DynaPlexProvider;
 
     public: 
+        /// gathers the bytes of all ranks (indexed by rank) on rank 0, or on all ranks if the last argument is true; returns false on all ranks if this is not possible.
+        using GatherCallback = std::function<bool(const std::vector<std::uint8_t>&, std::vector<std::vector<std::uint8_t>>&, bool)>;
+
         System();
-        System(bool TorchAvailable, std::uint32_t worldRank, std::uint32_t worldSize, std::function<void()> barrier_cb);
+        System(bool TorchAvailable, std::uint32_t worldRank, std::uint32_t worldSize, std::function<void()> barrier_cb, GatherCallback gather_cb = nullptr);
         ~System();
 
         System(const System&);  // Copy constructor
@@ -24,6 +31,8 @@ namespace DynaPlex {
         /// hardwarethreads available for the process or algorithm that receives this system.
         std::uint32_t HardwareThreads() const;
         std::uint32_t WorldRank() const;
+        /// persistent pool of HardwareThreads() workers, shared by all copies of this System; started on first use. 
+        Parallel::ThreadPool& Pool() const;
         std::uint32_t WorldSize() const;
 
         /// takes a path to a file (existing or not) and sets or replaces the file extension. 
@@ -96,6 +105,17 @@ namespace DynaPlex {
         ///adds a MPI barrier, if applicable 
         void AddBarrier() const;
 
+        /// whether Gather may succeed, i.e. whether MPI is available.
+        bool SupportsGather() const;
+        /**
+         * Collective call: gathers bytes from all ranks on rank 0, where gathered[rank] holds the bytes of that rank; on other
+         * ranks gathered is empty. Returns false on all ranks if the bytes could not be gathered (e.g. without MPI, or if
+         * the total exceeds the MPI message limit), such that callers can fall back to exchanging files.
+         */
+        bool Gather(const std::vector<std::uint8_t>& bytes, std::vector<std::vector<std::uint8_t>>& gathered) const;
+        /// Collective call: as Gather, but all ranks receive the bytes of all ranks.
+        bool AllGather(const std::vector<std::uint8_t>& bytes, std::vector<std::vector<std::uint8_t>>& gathered) const;
+
         /// if this process has world_rank 0, displays message on console. Otherwise, does nothing. 
         friend const System& operator<<(const System& sys, const std::string& msg);
 
@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace DynaPlex::Parallel {
+	/**
+	 * Persistent pool of worker threads that execute batches of indexed tasks. Each worker has its own queue, and idle workers
+	 * steal from the queues of others, such that tasks of unequal duration keep all workers busy. Instead of constructing a pool,
+	 * use the pool shared by all copies of a DynaPlex::System, see System::Pool().
+	 */
+	class ThreadPool {
+	public:
+		using Task = std::function<void(int64_t)>;
+		using WhileWaiting = std::function<void(const std::atomic<bool>&)>;
+
+		explicit ThreadPool(size_t num_threads);
+		~ThreadPool();
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		/// number of worker threads.
+		size_t NumThreads() const;
+
+		/**
+		 * Executes task(i) for all i in [0, num_tasks), and blocks until all are done. If a task throws, the tasks of this batch
+		 * that did not start yet are cancelled, and the first exception is rethrown. If provided, while_waiting is executed
+		 * on the calling thread while the workers execute the tasks; its argument is the cancellation flag of the batch.
+		 * May be called from within a task (nested parallelism): the calling worker then executes queued tasks while it waits.
+		 */
+		void Run(int64_t num_tasks, const Task& task, const WhileWaiting& while_waiting = nullptr);
+
+	private:
+		struct Batch;
+		struct Item {
+			Batch* batch;
+			int64_t index;
+		};
+		struct Queue {
+			std::mutex mutex;
+			std::deque<Item> items;
+		};
+
+		bool TryExecute(size_t home);
+		void Execute(const Item& item);
+		void WorkerLoop(size_t id);
+
+		std::vector<std::unique_ptr<Queue>> queues;
+		std::atomic<int64_t> queued;
+		std::mutex wake_mutex;
+		std::condition_variable wake;
+		bool stopping;
+		std::vector<std::jthread> workers;
+	};
+}
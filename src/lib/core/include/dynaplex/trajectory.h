@@ -83,6 +83,12 @@ namespace DynaPlex {
 			state.reset(); 			
 		}
 
+		/// moves the state out of the trajectory, for instance to reuse it elsewhere; leaves the trajectory without state.
+		DynaPlex::dp_State ReleaseState()
+		{
+			return std::move(state);
+		}
+
 		/// moves the state into the trajectory, and re-initiates CumulativeReturn, EffectiveDiscountFactor, and PeriodCount. 
 		void Reset(DynaPlex::dp_State&&);
 		
@@ -1,5 +1,7 @@
 #pragma once
+#include <cstdint>
 #include <memory>
+#include <span>
 #include <string>
 #include <variant>
 #include <vector>
@@ -310,6 +312,11 @@ namespace DynaPlex {
 		void SaveToFile(const std::string& filePath, const int indent = -1) const;
 		static VarGroup LoadFromFile(const std::string& filePath);
 
+		/// Compact binary (CBOR) representation of this VarGroup, that is faster to write and parse than json. See FromBinary.
+		std::vector<uint8_t> ToBinary() const;
+		/// Reconstructs the VarGroup from the output of ToBinary.
+		static VarGroup FromBinary(std::span<const uint8_t> bytes);
+
 		std::string Hash() const;
 		int64_t Int64Hash() const;
 		std::string ToAbbrvString() const;
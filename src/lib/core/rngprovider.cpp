@@ -7,9 +7,9 @@ namespace DynaPlex {
 		this->trajectory = trajectory;
 		this->eval = evaluation;
 
+		//keeps the capacity, such that reseeding a provider does not allocate.
 		rng_vec.clear();
-		//start with 3 event streams.
-		Expand(3);
+		seeded = true;
 
 	}
 }
@@ -0,0 +1,44 @@
+#include "dynaplex/statepool.h"
+namespace DynaPlex {
+
+	void StatePool::Lend(std::span<Trajectory> trajectories)
+	{
+		for (auto& traj : trajectories)
+		{
+			if (pool.empty())
+				break;
+			if (!traj.HasState())
+			{
+				traj.Reset(std::move(pool.back()));
+				pool.pop_back();
+			}
+		}
+	}
+
+	void StatePool::Return(std::span<Trajectory> trajectories)
+	{
+		for (auto& traj : trajectories)
+		{
+			if (!traj.HasState())
+				continue;
+			if (pool.size() < capacity)
+				pool.push_back(traj.ReleaseState());
+			else
+				traj.ReleaseState();
+		}
+	}
+
+	StatePool& StatePool::ForThread(const DynaPlex::MDP& mdp)
+	{
+		thread_local StatePool state_pool{};
+		//weak, so the pool does not extend the lifetime of the mdp:
+		thread_local std::weak_ptr<MDPInterface> owner{};
+		bool same_owner = !owner.expired() && !owner.owner_before(mdp) && !mdp.owner_before(owner);
+		if (!same_owner)
+		{
+			state_pool.Clear();
+			owner = mdp;
+		}
+		return state_pool;
+	}
+}
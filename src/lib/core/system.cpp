@@ -1,21 +1,32 @@
 #include <chrono>
 #include <filesystem>
 #include <functional>
+#include <mutex>
+#include <algorithm>
 #include <thread>  // for std::thread::hardware_concurrency
 #include <iomanip> // for std::setw, std::setfill
 #include "dynaplex/system.h"
 #include "dynaplex/error.h"
+#include "dynaplex/threadpool.h"
 namespace fs = std::filesystem;
 
 namespace DynaPlex {
 
     class System::Impl {
     public:
-        Impl(bool torchavailable, int32_t world_rank, int32_t world_size, std::function<void()> barrier_cb) : start_time_(std::chrono::steady_clock::now()),
+        //shared between copies, such that all copies use a single pool.
+        struct PoolHolder {
+            std::once_flag once;
+            std::unique_ptr<Parallel::ThreadPool> pool;
+        };
+
+        Impl(bool torchavailable, int32_t world_rank, int32_t world_size, std::function<void()> barrier_cb, GatherCallback gather_cb) : start_time_(std::chrono::steady_clock::now()),
             hardware_threads_(std::thread::hardware_concurrency()),
             world_rank_(world_rank),
             world_size_(world_size),
-            barrier_callback_(barrier_cb) {
+            barrier_callback_(barrier_cb),
+            gather_callback_(gather_cb),
+            pool_holder_(std::make_shared<PoolHolder>()) {
 
         }
         // Default copy constructor
@@ -63,6 +74,8 @@ namespace DynaPlex {
         bool torchavailable;
         fs::path io_location_;
         std::function<void()> barrier_callback_;
+        GatherCallback gather_callback_;
+        std::shared_ptr<PoolHolder> pool_holder_;
     };
 
 
@@ -79,18 +92,36 @@ namespace DynaPlex {
             pimpl->barrier_callback_();
         }
     }
+    bool System::SupportsGather() const {
+        return static_cast<bool>(pimpl->gather_callback_);
+    }
+
+    bool System::Gather(const std::vector<std::uint8_t>& bytes, std::vector<std::vector<std::uint8_t>>& gathered) const {
+        gathered.clear();
+        if (!pimpl->gather_callback_)
+            return false;
+        return pimpl->gather_callback_(bytes, gathered, false);
+    }
+
+    bool System::AllGather(const std::vector<std::uint8_t>& bytes, std::vector<std::vector<std::uint8_t>>& gathered) const {
+        gathered.clear();
+        if (!pimpl->gather_callback_)
+            return false;
+        return pimpl->gather_callback_(bytes, gathered, true);
+    }
     System::System() = default;
-    System::System(bool torchavailable, std::uint32_t worldRank, std::uint32_t worldSize, std::function<void()> barrier_cb)
-        : pimpl(std::make_unique<Impl>(torchavailable, worldRank, worldSize,barrier_cb)) {
+    System::System(bool torchavailable, std::uint32_t worldRank, std::uint32_t worldSize, std::function<void()> barrier_cb, GatherCallback gather_cb)
+        : pimpl(std::make_unique<Impl>(torchavailable, worldRank, worldSize,barrier_cb, gather_cb)) {
     }
     System::~System() = default;
 
+    //default-constructed systems (e.g. in default-constructed members) have no Impl, and may be copied as well.
     System::System(const System& other)
-        : pimpl(std::make_unique<Impl>(*other.pimpl)) {}
+        : pimpl(other.pimpl ? std::make_unique<Impl>(*other.pimpl) : nullptr) {}
 
     System& System::operator=(const System& other) {
         if (this != &other) {
-            pimpl = std::make_unique<Impl>(*other.pimpl);
+            pimpl = other.pimpl ? std::make_unique<Impl>(*other.pimpl) : nullptr;
         }
         return *this;
     }
@@ -100,6 +131,14 @@ namespace DynaPlex {
         return pimpl->hardware_threads_;
     }
 
+    Parallel::ThreadPool& System::Pool() const {
+        auto& holder = *pimpl->pool_holder_;
+        std::call_once(holder.once, [this, &holder]() {
+            holder.pool = std::make_unique<Parallel::ThreadPool>(std::max<std::uint32_t>(pimpl->hardware_threads_, 1));
+            });
+        return *holder.pool;
+    }
+
     std::uint32_t System::WorldRank() const {
         return pimpl->world_rank_;
     }
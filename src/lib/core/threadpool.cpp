@@ -0,0 +1,161 @@
+#include "dynaplex/threadpool.h"
+#include "dynaplex/error.h"
+#include <exception>
+
+namespace DynaPlex::Parallel {
+
+	namespace {
+		//identifies the pool and queue of the worker running on this thread, if any.
+		thread_local const ThreadPool* current_pool = nullptr;
+		thread_local size_t current_worker = 0;
+	}
+
+	struct ThreadPool::Batch {
+		const Task* task;
+		int64_t remaining;
+		std::atomic<bool> cancelled;
+		std::exception_ptr error;
+		std::mutex mutex;
+		std::condition_variable done;
+	};
+
+	ThreadPool::ThreadPool(size_t num_threads)
+		: queues{}, queued{ 0 }, stopping{ false }, workers{}
+	{
+		if (num_threads == 0)
+			throw DynaPlex::Error("ThreadPool: num_threads must be positive.");
+		for (size_t id = 0; id < num_threads; id++)
+			queues.push_back(std::make_unique<Queue>());
+		//start the workers only after all queues exist, as workers steal from all queues.
+		for (size_t id = 0; id < num_threads; id++)
+			workers.emplace_back([this, id]() { WorkerLoop(id); });
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(wake_mutex);
+			stopping = true;
+		}
+		wake.notify_all();
+		// Destroying the threads joins them.
+		workers.clear();
+	}
+
+	size_t ThreadPool::NumThreads() const
+	{
+		return queues.size();
+	}
+
+	void ThreadPool::WorkerLoop(size_t id)
+	{
+		current_pool = this;
+		current_worker = id;
+		while (true)
+		{
+			if (TryExecute(id))
+				continue;
+			std::unique_lock<std::mutex> lock(wake_mutex);
+			wake.wait(lock, [this]() { return stopping || queued.load() > 0; });
+			if (stopping && queued.load() <= 0)
+				return;
+		}
+	}
+
+	bool ThreadPool::TryExecute(size_t home)
+	{
+		size_t n = queues.size();
+		for (size_t k = 0; k < n; k++)
+		{
+			Queue& queue = *queues[(home + k) % n];
+			std::unique_lock<std::mutex> lock(queue.mutex);
+			if (queue.items.empty())
+				continue;
+			//take work from the front of the own queue, and steal from the back of other queues.
+			Item item;
+			if (k == 0)
+			{
+				item = queue.items.front();
+				queue.items.pop_front();
+			}
+			else
+			{
+				item = queue.items.back();
+				queue.items.pop_back();
+			}
+			lock.unlock();
+			queued--;
+			Execute(item);
+			return true;
+		}
+		return false;
+	}
+
+	void ThreadPool::Execute(const Item& item)
+	{
+		Batch& batch = *item.batch;
+		std::exception_ptr error{};
+		if (!batch.cancelled)
+		{
+			try {
+				(*batch.task)(item.index);
+			}
+			catch (...) {
+				error = std::current_exception();
+				batch.cancelled = true;
+			}
+		}
+		//the batch lives on the stack of Run, which may return as soon as remaining hits zero and the mutex is released.
+		std::lock_guard<std::mutex> lock(batch.mutex);
+		if (error && !batch.error)
+			batch.error = error;
+		if (--batch.remaining == 0)
+			batch.done.notify_all();
+	}
+
+	void ThreadPool::Run(int64_t num_tasks, const Task& task, const WhileWaiting& while_waiting)
+	{
+		if (num_tasks <= 0)
+			return;
+		Batch batch{ &task, num_tasks, false, nullptr, {}, {} };
+
+		bool is_worker = current_pool == this;
+		size_t n = queues.size();
+		//hand out contiguous blocks of tasks; a nested batch starts at the queue of the calling worker.
+		size_t first = is_worker ? current_worker : 0;
+		queued += num_tasks;
+		for (size_t q = 0; q < n; q++)
+		{
+			int64_t begin = num_tasks * static_cast<int64_t>(q) / static_cast<int64_t>(n);
+			int64_t end = num_tasks * static_cast<int64_t>(q + 1) / static_cast<int64_t>(n);
+			if (begin == end)
+				continue;
+			Queue& queue = *queues[(first + q) % n];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			for (int64_t index = begin; index < end; index++)
+				queue.items.push_back({ &batch, index });
+		}
+		{
+			std::lock_guard<std::mutex> lock(wake_mutex);
+		}
+		wake.notify_all();
+
+		if (while_waiting)
+			while_waiting(batch.cancelled);
+		if (is_worker)
+		{
+			//all workers may be waiting on nested batches, so help instead of blocking.
+			while (TryExecute(current_worker))
+			{
+				std::lock_guard<std::mutex> lock(batch.mutex);
+				if (batch.remaining == 0)
+					break;
+			}
+		}
+
+		std::unique_lock<std::mutex> lock(batch.mutex);
+		batch.done.wait(lock, [&batch]() { return batch.remaining == 0; });
+		if (batch.error)
+			std::rethrow_exception(batch.error);
+	}
+}
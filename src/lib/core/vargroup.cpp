@@ -515,6 +515,23 @@ namespace DynaPlex {
 		}
 	}
 
+	std::vector<uint8_t> VarGroup::ToBinary() const {
+		return ordered_json::to_cbor(pImpl->data);
+	}
+
+	VarGroup VarGroup::FromBinary(std::span<const uint8_t> bytes) {
+		ordered_json j;
+		try {
+			j = ordered_json::from_cbor(bytes.begin(), bytes.end());
+		}
+		catch (const nlohmann::json::exception& e) {
+			throw DynaPlex::Error(std::string("VarGroup::FromBinary: failed to parse binary data - ") + e.what());
+		}
+		VarGroup VarGroup;
+		VarGroup.pImpl->data = std::move(j);
+		return VarGroup;
+	}
+
 	std::string VarGroup::Hash() const
 	{
 		return DynaPlex::VarGroupHelpers::hash_json_string(pImpl->data);
@@ -1,6 +1,7 @@
 #include <iostream>
 #ifdef DP_MPI_AVAILABLE
 #include <mpi.h>
+#include <climits>
 #endif
 #include "dynaplex/torchavailability.h"
 #include "dynaplex/dynaplexprovider.h"
@@ -44,6 +45,51 @@ namespace DynaPlex {
 #endif
     }
 
+    bool DynaPlexProvider::Gather(const std::vector<std::uint8_t>& bytes, std::vector<std::vector<std::uint8_t>>& gathered, bool to_all_ranks)
+    {
+#ifdef DP_MPI_AVAILABLE
+        int world_rank;
+        int world_size;
+        MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+        MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+        bool receives = to_all_ranks || world_rank == 0;
+        int64_t count = static_cast<int64_t>(bytes.size());
+        std::vector<int64_t> counts(receives ? world_size : 0);
+        if (to_all_ranks)
+            MPI_Allgather(&count, 1, MPI_INT64_T, counts.data(), 1, MPI_INT64_T, MPI_COMM_WORLD);
+        else
+            MPI_Gather(&count, 1, MPI_INT64_T, counts.data(), 1, MPI_INT64_T, 0, MPI_COMM_WORLD);
+
+        //MPI_Gatherv takes int counts and displacements; rank 0 decides for all ranks whether the bytes fit.
+        std::vector<int> int_counts(counts.size());
+        std::vector<int> displacements(counts.size());
+        int64_t total = 0;
+        for (size_t rank = 0; rank < counts.size(); rank++)
+        {
+            int_counts[rank] = static_cast<int>(counts[rank]);
+            displacements[rank] = static_cast<int>(total);
+            total += counts[rank];
+        }
+        int fits = total <= INT_MAX ? 1 : 0;
+        MPI_Bcast(&fits, 1, MPI_INT, 0, MPI_COMM_WORLD);
+        if (!fits)
+            return false;
+
+        std::vector<std::uint8_t> buffer(static_cast<size_t>(total));
+        if (to_all_ranks)
+            MPI_Allgatherv(bytes.data(), static_cast<int>(count), MPI_BYTE, buffer.data(), int_counts.data(), displacements.data(), MPI_BYTE, MPI_COMM_WORLD);
+        else
+            MPI_Gatherv(bytes.data(), static_cast<int>(count), MPI_BYTE, buffer.data(), int_counts.data(), displacements.data(), MPI_BYTE, 0, MPI_COMM_WORLD);
+        for (size_t rank = 0; rank < counts.size(); rank++)
+            gathered.emplace_back(buffer.begin() + displacements[rank], buffer.begin() + displacements[rank] + int_counts[rank]);
+        return true;
+#else
+        gathered = { bytes };
+        return true;
+#endif
+    }
+
     DynaPlexProvider::DynaPlexProvider() {
         // If MPI is available, initialize it and fetch world details
 #ifdef DP_MPI_AVAILABLE
@@ -64,7 +110,12 @@ namespace DynaPlex {
         bool torchavailable = DynaPlex::TorchAvailability::TorchAvailable();
       
         m_systemInfo = DynaPlex::System(torchavailable,world_rank, world_size,
-           /*callback function: */ []() {DynaPlexProvider::Get().AddBarrier(); }
+           /*callback function: */ []() {DynaPlexProvider::Get().AddBarrier(); },
+#ifdef DP_MPI_AVAILABLE
+           /*callback function: */ [](const std::vector<std::uint8_t>& bytes, std::vector<std::vector<std::uint8_t>>& gathered, bool to_all_ranks) {return DynaPlexProvider::Get().Gather(bytes, gathered, to_all_ranks); }
+#else
+            nullptr
+#endif
             );
         std::string defined_root_dir = "";
 #ifdef DYNAPLEX_IO_ROOT_DIR
@@ -150,4 +201,9 @@ namespace DynaPlex {
         return DynaPlex::Utilities::PolicyComparer(m_systemInfo,mdp, config);
     }
 
+    DynaPlex::Utilities::ParameterSearch DynaPlexProvider::GetParameterSearch(DynaPlex::MDP mdp, const VarGroup& config)
+    {
+        return DynaPlex::Utilities::ParameterSearch(m_systemInfo, mdp, config);
+    }
+
 }  // namespace DynaPlex
@@ -5,6 +5,7 @@
 #include "dynaplex/system.h"
 #include "dynaplex/demonstrator.h"
 #include "dynaplex/policycomparer.h"
+#include "dynaplex/parametersearch.h"
 #include "dynaplex/dcl.h"
 namespace DynaPlex {
     class DynaPlexProvider {
@@ -55,9 +56,18 @@ namespace DynaPlex {
          */
         DynaPlex::Utilities::PolicyComparer GetPolicyComparer(DynaPlex::MDP mdp, const VarGroup& config = VarGroup{});
 
+        /**
+         * Gets a search over integer policy parameters for a specific mdp, which evaluates candidates with a PolicyComparer.
+         * Config may include max_iterations (default: 100), initial_step (default: 4), z_value (default: 2.0), rng_seed
+         * (default: 13021984; each evaluation uses a subsequent seed), and PolicyComparer settings such as number_of_trajectories.
+         * See the ParameterSearch constructor for details.
+         */
+        DynaPlex::Utilities::ParameterSearch GetParameterSearch(DynaPlex::MDP mdp, const VarGroup& config = VarGroup{});
+
 
     private:
         void AddBarrier();
+        bool Gather(const std::vector<std::uint8_t>& bytes, std::vector<std::vector<std::uint8_t>>& gathered, bool to_all_ranks);
         DynaPlexProvider(); 
         ~DynaPlexProvider();
         // Delete the copy and assignment constructors to ensure singleton behavior
@@ -3,6 +3,7 @@
 #include <memory>
 #include "dynaplex/error.h"
 #include "dynaplex/statecategory.h"
+#include "dynaplex/actionmask.h"
 #include "erasure_concepts.h"
 
 
@@ -28,12 +29,14 @@ namespace DynaPlex::Erasure
         using State = typename t_MDP::State;
         const t_MDP& mdp;
         const State& state;
+        //allowed actions, if provided by the mdp; nullptr otherwise. 
+        const DynaPlex::ActionMask* mask;
         int64_t current_action;
         int64_t max_action;
 
     public:
-        ActionIterator(const t_MDP& mdp, const State& state, int64_t current, int64_t max)
-            : mdp(mdp),state(state), current_action(current), max_action(max)
+        ActionIterator(const t_MDP& mdp, const State& state, const DynaPlex::ActionMask* mask, int64_t current, int64_t max)
+            : mdp(mdp),state(state), mask(mask), current_action(current), max_action(max)
         {}
 
         int64_t operator*() const
@@ -43,6 +46,11 @@ namespace DynaPlex::Erasure
 
         ActionIterator& operator++()
         {
+            if (mask)
+            {
+                current_action = mask->Next(current_action + 1);
+                return *this;
+            }
             do
             {
                 ++current_action;
@@ -67,59 +75,59 @@ namespace DynaPlex::Erasure
         using State = typename t_MDP::State;
 
         ActionRange(const t_MDP& mdp, const State& state,int64_t min_action, int64_t max_action)
-            : mdp(mdp), state(state), max_action(max_action)
+            : mdp(mdp), state(state), max_action(max_action), mask{}
         {
             first_action = min_action;
-            while (!IsAllowedAction<t_MDP>(mdp, state, first_action))
+            if constexpr (HasGetAllowedActions<t_MDP>)
             {
-                ++first_action;
+                //a single pass over all actions, after which iterating and counting only inspect the mask. 
+                mask.Reset(max_action);
+                mdp.GetAllowedActions(state, mask);
+                first_action = mask.Next(min_action);
                 if (first_action == max_action)
                 {
-                    std::string extra{};
-                    if constexpr (HasGetStateCategory<t_MDP>)
-                    {
-                        DynaPlex::StateCategory cat=mdp.GetStateCategory(state);
-                        if (!cat.IsAwaitAction())
-                        {
-                            extra += "\nNOTE: State is not AwaitAction.";
-                        }
-                    }
-                    if constexpr (DynaPlex::Concepts::ConvertibleToVarGroup<State>)
+                    ThrowNoValidAction();
+                }
+            }
+            else
+            {
+                while (!IsAllowedAction<t_MDP>(mdp, state, first_action))
+                {
+                    ++first_action;
+                    if (first_action == max_action)
                     {
-                        std::string s = "";
-                        try
-                        {
-                            s = state.ToVarGroup().ToAbbrvString();
-                        }
-                        catch (...) {
-                            s = "";
-                        };
-                        extra += "\n" + s;
+                        ThrowNoValidAction();
                     }
-                    throw DynaPlex::Error("ActionRange: State does not have a single valid action."+extra);
                 }
-            }        
+            }
         }
 
         ActionIterator<t_MDP> begin() const
         {
 
-            return { mdp, state, first_action, max_action };
+            return { mdp, state, MaskOrNull(), first_action, max_action };
         }
 
         ActionIterator<t_MDP> end() const
         {
-            return { mdp, state, max_action, max_action };
+            return { mdp, state, MaskOrNull(), max_action, max_action };
         }
 
         int64_t Count() const
         {
-            int64_t count = 0;
-            for (auto it = begin(); it != end(); ++it)
+            if constexpr (HasGetAllowedActions<t_MDP>)
+            {
+                return mask.Count();
+            }
+            else
             {
-                count++;
+                int64_t count = 0;
+                for (auto it = begin(); it != end(); ++it)
+                {
+                    count++;
+                }
+                return count;
             }
-            return count;
         }
 
     private:
@@ -127,6 +135,41 @@ namespace DynaPlex::Erasure
         const State& state;
         int64_t max_action;
         int64_t first_action;
+        DynaPlex::ActionMask mask;
+
+        const DynaPlex::ActionMask* MaskOrNull() const
+        {
+            if constexpr (HasGetAllowedActions<t_MDP>)
+                return &mask;
+            else
+                return nullptr;
+        }
+
+        [[noreturn]] void ThrowNoValidAction() const
+        {
+            std::string extra{};
+            if constexpr (HasGetStateCategory<t_MDP>)
+            {
+                DynaPlex::StateCategory cat=mdp.GetStateCategory(state);
+                if (!cat.IsAwaitAction())
+                {
+                    extra += "\nNOTE: State is not AwaitAction.";
+                }
+            }
+            if constexpr (DynaPlex::Concepts::ConvertibleToVarGroup<State>)
+            {
+                std::string s = "";
+                try
+                {
+                    s = state.ToVarGroup().ToAbbrvString();
+                }
+                catch (...) {
+                    s = "";
+                };
+                extra += "\n" + s;
+            }
+            throw DynaPlex::Error("ActionRange: State does not have a single valid action."+extra);
+        }
     };
 
 
@@ -161,15 +204,24 @@ namespace DynaPlex::Erasure
 
         int64_t CountAllowedActions(const typename t_MDP::State& state) const
         {
-            int64_t counter = 0;
-            for (int64_t action = min_action; action < max_action; action++)
+            if constexpr (HasGetAllowedActions<t_MDP>)
             {
-                if (IsAllowedAction(state, action))
+                DynaPlex::ActionMask mask(max_action);
+                mdp->GetAllowedActions(state, mask);
+                return mask.Count();
+            }
+            else
+            {
+                int64_t counter = 0;
+                for (int64_t action = min_action; action < max_action; action++)
                 {
-                    counter++;
+                    if (IsAllowedAction(state, action))
+                    {
+                        counter++;
+                    }
                 }
+                return counter;
             }
-            return counter;
         }
         
         ActionRange<t_MDP> operator()(const typename t_MDP::State& state) const
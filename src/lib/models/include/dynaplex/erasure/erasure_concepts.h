@@ -1,10 +1,13 @@
 #pragma once
 #include <type_traits>
+#include <concepts>
 #include "dynaplex/vargroup.h"
 #include "dynaplex/features.h"
 #include "dynaplex/statecategory.h"
+#include "dynaplex/actionmask.h"
 #include <vector>
 #include <tuple>
+#include <optional>
 namespace DynaPlex::Erasure
 {
 	template <typename t_MDP,typename t_State>
@@ -42,6 +45,17 @@ namespace DynaPlex::Erasure
 		{ mdp.GetEvent(rng) } -> std::same_as<t_Event>;
 	};
 
+	//optional: fills a caller-provided event, so that the adapter can reuse one event buffer across calls.
+	template <typename t_MDP, typename t_Event, typename t_RNG>
+	concept HasGetEventInPlace = std::default_initializable<t_Event> && requires(const t_MDP & mdp, t_RNG & rng, t_Event & event) {
+		{ mdp.GetEvent(rng, event) } -> std::same_as<void>;
+	};
+
+	template <typename t_MDP, typename t_State, typename t_Event, typename t_RNG>
+	concept HasGetStateDependentEventInPlace = std::default_initializable<t_Event> && requires(const t_MDP & mdp, const t_State & state, t_RNG & rng, t_Event & event) {
+		{ mdp.GetEvent(state, rng, event) } -> std::same_as<void>;
+	};
+
 	template <typename t_MDP, typename t_State, typename t_RNG>
 	concept HasResetHiddenStateVariables = requires(const t_MDP & mdp, t_State & state, t_RNG & rng) {
 		mdp.ResetHiddenStateVariables(state, rng);
@@ -68,6 +82,18 @@ namespace DynaPlex::Erasure
 		{ mdp.IsAllowedAction(state, action) } -> std::same_as<bool>;
 	};
 
+	template <typename t_MDP>
+	concept HasGetAllowedActions = requires(const t_MDP mdp, const typename t_MDP::State state, DynaPlex::ActionMask & mask)
+	{
+		{ mdp.GetAllowedActions(state, mask) } -> std::same_as<void>;
+	};
+
+	template <typename t_MDP>
+	concept HasTrivialAction = requires(const t_MDP mdp, const typename t_MDP::State state)
+	{
+		{ mdp.TrivialAction(state) } -> std::same_as<std::optional<int64_t>>;
+	};
+
 	template<typename t_MDP>
 	concept HasGetStateCategory = requires(t_MDP a, const typename t_MDP::State & s) {
 		{ a.GetStateCategory(s) } -> std::same_as<StateCategory>;
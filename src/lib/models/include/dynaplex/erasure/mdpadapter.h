@@ -1,5 +1,7 @@
 #pragma once
 #include <vector>
+#include <algorithm>
+#include <utility>
 #include "dynaplex/vargroup.h"
 #include "dynaplex/error.h"
 #include "dynaplex/rng.h"
@@ -24,6 +26,9 @@ namespace DynaPlex::Erasure
 		static_assert(HasGetStaticInfo<t_MDP>, "MDP must publicly define GetStaticInfo() const returning DynaPlex::VarGroup.");
 		using t_State = typename t_MDP::State;
 		using t_Event = typename ConditionalEvent<t_MDP, HasEvent<t_MDP>>::type;
+		//scratch event that is reused across GetEvent calls if the MDP supports filling events in place.
+		using t_EventBuffer = std::conditional_t<HasGetEventInPlace<t_MDP, t_Event, DynaPlex::RNG>
+			|| HasGetStateDependentEventInPlace<t_MDP, t_State, t_Event, DynaPlex::RNG>, t_Event, int64_t>;
 
 		static_assert(DynaPlex::Concepts::ConvertibleToVarGroup<t_State>, "MDP::State must define VarGroup ToVarGroup() const");
 
@@ -460,77 +465,109 @@ namespace DynaPlex::Erasure
 			policy->SetAction(trajectories);
 			IncorporateAction(trajectories);
 		}
-		template <bool SkipTrivial>
-		bool IncorporateUntilSomeAction(std::span<DynaPlex::Trajectory> trajectories, int64_t MaxPeriodCount) const
+		//incorporates a single event into a trajectory that IsAwaitEvent, and updates its category.
+		void IncorporateEvent(DynaPlex::Trajectory& traj, t_State& t_state, [[maybe_unused]] t_EventBuffer& event_buffer) const
 		{
-			bool AllAwaitAction = true;
+			auto event_stream = traj.Category.Index();
+			if (event_stream == 0)
+			{
+				traj.PeriodCount++;
+				traj.EffectiveDiscountFactor *= discount_factor;
+			}
+			if constexpr (HasModifyStateWithEvent<t_MDP, t_State, t_Event>)
+			{
+				if constexpr (HasGetEventInPlace<t_MDP, t_Event, DynaPlex::RNG>)
+				{
+					mdp->GetEvent(traj.RNGProvider.GetEventRNG(event_stream), event_buffer);
+					traj.CumulativeReturn += mdp->ModifyStateWithEvent(t_state, event_buffer) * traj.EffectiveDiscountFactor;
+				}
+				else if constexpr (HasGetStateDependentEventInPlace<t_MDP, t_State, t_Event, DynaPlex::RNG>)
+				{
+					mdp->GetEvent(t_state, traj.RNGProvider.GetEventRNG(event_stream), event_buffer);
+					traj.CumulativeReturn += mdp->ModifyStateWithEvent(t_state, event_buffer) * traj.EffectiveDiscountFactor;
+				}
+				else if constexpr (HasGetEvent<t_MDP, t_Event, DynaPlex::RNG>)
+				{
+					t_Event Event = mdp->GetEvent(traj.RNGProvider.GetEventRNG(event_stream));
+					traj.CumulativeReturn += mdp->ModifyStateWithEvent(t_state, Event) * traj.EffectiveDiscountFactor;
+				}
+				else if constexpr (HasGetStateDependentEvent<t_MDP, t_State, t_Event, DynaPlex::RNG>)
+				{
+					t_Event Event = mdp->GetEvent(t_state, traj.RNGProvider.GetEventRNG(event_stream));
+					traj.CumulativeReturn += mdp->ModifyStateWithEvent(t_state, Event) * traj.EffectiveDiscountFactor;
+				}
+				else
+					throw DynaPlex::Error("MDP->IncorporateEvent: " + mdp_type_id + "\nMDP does not publicly define function GetEvent(DynaPlex::RNG&) returning MDP::Event. ");
+			}
+			else
+				if constexpr (HasModifyStateWithRNG<t_MDP, t_State, DynaPlex::RNG>)
+				{
+					traj.CumulativeReturn += mdp->ModifyStateWithEvent(t_state, traj.RNGProvider.GetEventRNG(event_stream)) * traj.EffectiveDiscountFactor;
+				}
+				else
+					throw DynaPlex::Error("MDP->IncorporateEvent: " + mdp_type_id + "\nMDP does not publicly define ModifyStateWithEvent(MDP::State&, const MDP::Event&) returning double.");
+			traj.Category = mdp->GetStateCategory(t_state);
+		}
 
-			for (DynaPlex::Trajectory& traj : trajectories)
+		//incorporates events into a single trajectory, until it awaits a (non-trivial, if SkipTrivial) action, is final, or reaches MaxPeriodCount.
+		//returns whether the trajectory awaits an action.
+		template <bool SkipTrivial>
+		bool IncorporateUntilSomeAction(DynaPlex::Trajectory& traj, t_State& t_state, t_EventBuffer& event_buffer, int64_t MaxPeriodCount) const
+		{
+			while (traj.PeriodCount < MaxPeriodCount && traj.Category.IsAwaitEvent())
 			{
-				auto& t_state = ToState(traj.GetState());
+				IncorporateEvent(traj, t_state, event_buffer);
 
-				while (traj.PeriodCount < MaxPeriodCount && traj.Category.IsAwaitEvent())
+				if constexpr (SkipTrivial)
 				{
-					auto event_stream = traj.Category.Index();
-					if (event_stream == 0)
+					while (traj.Category.IsAwaitAction())
 					{
-						traj.PeriodCount++;
-						traj.EffectiveDiscountFactor *= discount_factor;
-					}
-					if constexpr (HasModifyStateWithEvent<t_MDP, t_State, t_Event>)
-					{
-						if constexpr (HasGetEvent<t_MDP, t_Event, DynaPlex::RNG>)
-						{
-							t_Event Event = mdp->GetEvent(traj.RNGProvider.GetEventRNG(event_stream));
-							traj.CumulativeReturn += mdp->ModifyStateWithEvent(t_state, Event) * traj.EffectiveDiscountFactor;
-						}
-						else if constexpr (HasGetStateDependentEvent<t_MDP, t_State, t_Event, DynaPlex::RNG>)
-						{
-							t_Event Event = mdp->GetEvent(t_state, traj.RNGProvider.GetEventRNG(event_stream));
-							traj.CumulativeReturn += mdp->ModifyStateWithEvent(t_state, Event) * traj.EffectiveDiscountFactor;
+						std::optional<int64_t> trivial_action{};
+						if constexpr (HasTrivialAction<t_MDP>)
+						{//the mdp decides cheaply whether the decision is trivial, without enumerating the allowed actions.
+							trivial_action = mdp->TrivialAction(t_state);
 						}
 						else
-							throw DynaPlex::Error("MDP->IncorporateEvent: " + mdp_type_id + "\nMDP does not publicly define function GetEvent(DynaPlex::RNG&) returning MDP::Event. ");
-					}
-					else
-						if constexpr (HasModifyStateWithRNG<t_MDP, t_State, DynaPlex::RNG>)
-						{
-							traj.CumulativeReturn += mdp->ModifyStateWithEvent(t_state, traj.RNGProvider.GetEventRNG(event_stream)) * traj.EffectiveDiscountFactor;
-						}
-						else							
-							throw DynaPlex::Error("MDP->IncorporateEvent: " + mdp_type_id + "\nMDP does not publicly define ModifyStateWithEvent(MDP::State&, const MDP::Event&) returning double.");
-					traj.Category = mdp->GetStateCategory(t_state);
-
-					int64_t action_count;
-					if constexpr (SkipTrivial)
-					{
-						while (traj.Category.IsAwaitAction())
 						{
 							auto actions = provider(t_state);
 							if (actions.Count() == 1)
-							{//trivial action:	
-								traj.NextAction = *(actions.begin());
-								if constexpr (HasModifyStateWithAction<t_MDP>)
-								{
-									traj.CumulativeReturn += mdp->ModifyStateWithAction(t_state, traj.NextAction) * traj.EffectiveDiscountFactor;
-									traj.Category = mdp->GetStateCategory(t_state);
-								}
-								else
-									throw DynaPlex::Error("MDP->IncorporateUntilNonTrivialAction: " + mdp_type_id + "\nMDP does not publicly define ModifyStateWithAction(MDP::State,int64_t) const returning double");
+								trivial_action = *(actions.begin());
+						}
+						if (trivial_action)
+						{//trivial action:	
+							traj.NextAction = *trivial_action;
+							if constexpr (HasModifyStateWithAction<t_MDP>)
+							{
+								traj.CumulativeReturn += mdp->ModifyStateWithAction(t_state, traj.NextAction) * traj.EffectiveDiscountFactor;
+								traj.Category = mdp->GetStateCategory(t_state);
 							}
 							else
-							{//nontrivial action:
-								break;//the inner while loop. 
-							}
+								throw DynaPlex::Error("MDP->IncorporateUntilNonTrivialAction: " + mdp_type_id + "\nMDP does not publicly define ModifyStateWithAction(MDP::State,int64_t) const returning double");
+						}
+						else
+						{//nontrivial action:
+							break;//the inner while loop. 
 						}
 					}
 				}
-				if (!traj.Category.IsAwaitAction())
+			}
+			assert(traj.Category.IsAwaitAction() || traj.Category.IsFinal() || traj.PeriodCount == MaxPeriodCount);
+			return traj.Category.IsAwaitAction();
+		}
+
+		template <bool SkipTrivial>
+		bool IncorporateUntilSomeAction(std::span<DynaPlex::Trajectory> trajectories, int64_t MaxPeriodCount) const
+		{
+			bool AllAwaitAction = true;
+			t_EventBuffer event_buffer{};
+
+			for (DynaPlex::Trajectory& traj : trajectories)
+			{
+				auto& t_state = ToState(traj.GetState());
+				if (!IncorporateUntilSomeAction<SkipTrivial>(traj, t_state, event_buffer, MaxPeriodCount))
 				{
 					AllAwaitAction = false;
 				}
-				assert(traj.Category.IsAwaitAction() || traj.Category.IsFinal() || traj.PeriodCount == MaxPeriodCount);
-
 			}
 			return AllAwaitAction;
 		}
@@ -551,50 +588,110 @@ namespace DynaPlex::Erasure
 		{
 
 			bool EventsRemaining = false;
+			t_EventBuffer event_buffer{};
 			for (DynaPlex::Trajectory& traj : trajectories)
 			{
 				if (traj.Category.IsAwaitEvent())
 				{
 					auto& t_state = ToState(traj.GetState());
-					auto event_stream = traj.Category.Index();
-					if (event_stream == 0)
+					IncorporateEvent(traj, t_state, event_buffer);
+					if (traj.Category.IsAwaitEvent())
 					{
-						traj.PeriodCount++;
-						traj.EffectiveDiscountFactor *= discount_factor;
+						EventsRemaining = true;
 					}
-					if constexpr (HasModifyStateWithEvent<t_MDP, t_State, t_Event>)
-					{
-						if constexpr (HasGetEvent<t_MDP, t_Event, DynaPlex::RNG>)
-						{
-							t_Event Event = mdp->GetEvent(traj.RNGProvider.GetEventRNG(event_stream));
-							traj.CumulativeReturn += mdp->ModifyStateWithEvent(t_state, Event) * traj.EffectiveDiscountFactor;
-						}
-						else if constexpr (HasGetStateDependentEvent<t_MDP, t_State, t_Event, DynaPlex::RNG>)
-						{
-							t_Event Event = mdp->GetEvent(t_state, traj.RNGProvider.GetEventRNG(event_stream));
-							traj.CumulativeReturn += mdp->ModifyStateWithEvent(t_state, Event) * traj.EffectiveDiscountFactor;
-						}
-						else
-							throw DynaPlex::Error("MDP->IncorporateEvent: " + mdp_type_id + "\nMDP does not publicly define function GetEvent(DynaPlex::RNG&) returning MDP::Event. ");
+				}
+			}
+			return EventsRemaining;
+		}
 
-					}
-					else //if constexpr 
-						if constexpr (HasModifyStateWithRNG<t_MDP, t_State, DynaPlex::RNG>)
-						{
-							traj.CumulativeReturn += mdp->ModifyStateWithEvent(t_state, traj.RNGProvider.GetEventRNG(event_stream)) * traj.EffectiveDiscountFactor;
-						}
-						else
-							throw DynaPlex::Error("MDP->IncorporateEvent: " + mdp_type_id + "\nMDP does not publicly define ModifyStateWithEvent(MDP::State&, const MDP::Event&) returning double.");
+		void Rollout(std::span<DynaPlex::Trajectory> trajectories, const DynaPlex::Policy& policy, int64_t MaxPeriodCount, bool SkipTrivialActions) const override
+		{
+			//policies obtained from this MDP know their own type, and dispatch back to the typed kernel below:
+			if (auto typed_policy = dynamic_cast<const TypedPolicyInterface<t_MDP>*>(policy.get()))
+			{
+				typed_policy->Rollout(*this, trajectories, MaxPeriodCount, SkipTrivialActions);
+				return;
+			}
+			//other policies (e.g. neural network policies) are called in batches:
+			int64_t steps_without_event = 0;
+			while (true)
+			{
+				int64_t periods_before = TotalPeriodCount(trajectories);
+				bool all_require_action = SkipTrivialActions ? IncorporateUntilNonTrivialAction(trajectories, MaxPeriodCount) : IncorporateUntilAction(trajectories, MaxPeriodCount);
+				if (TotalPeriodCount(trajectories) != periods_before)
+					steps_without_event = 0;
+				else if (++steps_without_event > max_actions_without_event)
+					ThrowNoEventError();
+				if (!all_require_action)
+				{
+					//This "sorts" the trajectories, such that the trajectories that are IsAwaitAction are at the front.
+					auto new_partition_point = std::partition(trajectories.begin(), trajectories.end(),
+						[](const DynaPlex::Trajectory& traj) {return traj.Category.IsAwaitAction(); }
+					);
+					trajectories = std::span<DynaPlex::Trajectory>(trajectories.begin(), new_partition_point);
+				}
+				if (trajectories.size() == 0)
+					break;
+				IncorporateAction(trajectories, policy);
+			}
+		}
 
-					traj.Category = mdp->GetStateCategory(t_state);
-					if (traj.Category.IsAwaitEvent())
+		/**
+		 * Typed implementation of Rollout, called back by policies of type TypedPolicyInterface<t_MDP>, with get_action
+		 * the concrete action selection of that policy. Trajectories are rolled out one by one, such that the complete inner loop
+		 * is free of virtual calls.
+		 */
+		template <typename t_GetAction>
+		void TypedRollout(std::span<DynaPlex::Trajectory> trajectories, int64_t MaxPeriodCount, bool SkipTrivialActions, int64_t policy_mdp_int_hash, const t_GetAction& get_action) const
+		{
+			if (policy_mdp_int_hash != mdp_int_hash)
+				throw DynaPlex::Error("Error in MDP->Rollout: It seems you tried to call with a policy not obtained from this MDP. Please note that policies, even "
+					"generic ones, can only act on states from the same mdp instance that the policy was obtained from.");
+			if constexpr (HasModifyStateWithAction<t_MDP>)
+			{
+				t_EventBuffer event_buffer{};
+				for (DynaPlex::Trajectory& traj : trajectories)
+				{
+					auto& t_state = ToState(traj.GetState());
+					int64_t period = traj.PeriodCount;
+					int64_t steps_without_event = 0;
+					while (SkipTrivialActions ? IncorporateUntilSomeAction<true>(traj, t_state, event_buffer, MaxPeriodCount)
+						: IncorporateUntilSomeAction<false>(traj, t_state, event_buffer, MaxPeriodCount))
 					{
-						EventsRemaining = true;
+						if (traj.PeriodCount != period)
+						{
+							period = traj.PeriodCount;
+							steps_without_event = 0;
+						}
+						else if (++steps_without_event > max_actions_without_event)
+							ThrowNoEventError();
+						traj.NextAction = get_action(std::as_const(t_state), traj);
+						traj.CumulativeReturn += mdp->ModifyStateWithAction(t_state, traj.NextAction) * traj.EffectiveDiscountFactor;
+						traj.Category = mdp->GetStateCategory(t_state);
 					}
 				}
 			}
-			return EventsRemaining;
+			else
+				throw DynaPlex::Error("MDP->Rollout: " + mdp_type_id + "\nMDP does not publicly define ModifyStateWithAction(MDP::State,int64_t) const returning double");
 		}
+
+		/// maximum number of consecutive actions in a rollout without any event; protects against mdps or policies that loop forever.
+		static constexpr int64_t max_actions_without_event = 1000000;
+
+		static int64_t TotalPeriodCount(std::span<const DynaPlex::Trajectory> trajectories)
+		{
+			int64_t total = 0;
+			for (const auto& traj : trajectories)
+				total += traj.PeriodCount;
+			return total;
+		}
+
+		void ThrowNoEventError() const
+		{
+			throw DynaPlex::Error("MDP->Rollout: " + mdp_type_id + "\nexpected an event within max_actions_without_event: "
+				+ std::to_string(max_actions_without_event) + " consecutive actions, but no event occurred. Check that the mdp and policy do not loop forever over actions.");
+		}
+
 		virtual void InitiateState(std::span<DynaPlex::Trajectory> trajectories) const override
 		{
 			if constexpr (HasGetInitialRandomState<t_MDP, DynaPlex::RNG>)
@@ -622,7 +719,20 @@ namespace DynaPlex::Erasure
 		{
 			for (DynaPlex::Trajectory& traj : trajectories)
 			{
-				traj.Reset(std::move(state->Clone()));
+				if constexpr (std::is_copy_assignable_v<t_State>)
+				{
+					//reuse the state already held by the trajectory (e.g. lent from a StatePool) by copying into it;
+					//this avoids allocating a clone, and typically reuses the memory of its members as well.
+					if (traj.HasState() && traj.GetState()->mdp_int_hash == mdp_int_hash)
+					{
+						ToState(traj.GetState()) = ToState(state);
+						traj.Reset();
+					}
+					else
+						traj.Reset(std::move(state->Clone()));
+				}
+				else
+					traj.Reset(std::move(state->Clone()));
 				auto& t_state = ToState(traj.GetState());
 				if constexpr (HasResetHiddenStateVariables<t_MDP, t_State, DynaPlex::RNG>)
 				{
@@ -9,8 +9,22 @@
 
 namespace DynaPlex::Erasure
 {
+	template<typename>
+	class MDPAdapter;
+
+	/**
+	 * Policy that acts on states of t_MDP, and that can run rollouts on the typed kernel of MDPAdapter<t_MDP>. 
+	 * MDPAdapter<t_MDP>::Rollout recovers this interface once per call, after which no virtual calls remain in the loop. 
+	 */
+	template<typename t_MDP>
+	class TypedPolicyInterface : public PolicyInterface
+	{
+	public:
+		virtual void Rollout(const MDPAdapter<t_MDP>& mdp_adapter, std::span<Trajectory> trajectories, int64_t MaxPeriodCount, bool SkipTrivialActions) const = 0;
+	};
+
 	template<typename t_MDP, typename t_Policy>
-	class PolicyAdapter final : public PolicyInterface
+	class PolicyAdapter final : public TypedPolicyInterface<t_MDP>
 	{
 		static_assert(HasState<t_MDP>, "MDP must publicly define a nested type or using declaration for State");
 		static_assert(HasGetStateCategory<t_MDP>, "MDP must publicly define a function GetStateCategory(const MDP::State) const that returns a StateCategory");
@@ -24,6 +38,20 @@ namespace DynaPlex::Erasure
 		std::string identifier;
 		int64_t mdp_int_hash;
 		const DynaPlex::VarGroup vars;
+
+		//dispatch to policy, depending on the signature of the GetAction implemented on the policy
+		int64_t GetAction(const t_State& state, Trajectory& traj) const
+		{
+			if constexpr (HasGetAction<t_Policy, t_State>)
+			{
+				return policy.GetAction(state);
+			}
+			else
+			{
+				RNG& rng = traj.RNGProvider.GetPolicyRNG();
+				return policy.GetAction(state, rng);
+			}
+		}
 	public:
 		const DynaPlex::VarGroup& GetConfig() const override
 		{
@@ -64,26 +92,19 @@ namespace DynaPlex::Erasure
 					//convert type-erased state to underlying type. 
 					StateAdapter<t_State>* adapter = static_cast<StateAdapter<t_State>*>(traj.GetState().get());
 					t_State& state = adapter->state;
-					//dispatch to policy, depending on the signature of the GetAction implemented
-					//on the policy
-					if constexpr (HasGetAction<t_Policy, t_State>)
-					{
-						traj.NextAction = policy.GetAction(state);
-					}
-					else
-					{
-						RNG& rng = traj.RNGProvider.GetPolicyRNG();
-						traj.NextAction = policy.GetAction(state, rng);
-					}
+					traj.NextAction = GetAction(state, traj);
 				}
 				else
 				{
 					throw DynaPlex::Error("Error in Policy->SetAction: Cannot set action when Trajectory.Category is not IsAwaitAction, i.e. when state is not IsAwaitAction.");
 				}
 			}
-
-			
 		}
 
+		void Rollout(const MDPAdapter<t_MDP>& mdp_adapter, std::span<Trajectory> trajectories, int64_t MaxPeriodCount, bool SkipTrivialActions) const override
+		{
+			mdp_adapter.TypedRollout(trajectories, MaxPeriodCount, SkipTrivialActions, mdp_int_hash,
+				[this](const t_State& state, Trajectory& traj) { return GetAction(state, traj); });
+		}
 	};
 }
@@ -24,11 +24,8 @@ namespace DynaPlex::Erasure
 
 		int64_t GetAction(const State& state, DynaPlex::RNG& rng) const
 		{
-			int64_t numAllowedActions{ 0 };
-			for (const int64_t action: provider(state))
-			{				
-				numAllowedActions++;				
-			}
+			auto actions = provider(state);
+			int64_t numAllowedActions = actions.Count();
 			if (numAllowedActions == 0)
 			{
 				throw DynaPlex::Error("RandomPolicy: Not a single action allowed.");
@@ -36,7 +33,7 @@ namespace DynaPlex::Erasure
 			double d_budget = rng.genUniform() * static_cast<double>(numAllowedActions);
 			int64_t budget = static_cast<int64_t>(d_budget);
 
-			for (const int64_t action : provider(state))
+			for (const int64_t action : actions)
 			{	
 				if (budget == 0)
 				{
@@ -1,5 +1,6 @@
 #pragma once
 #include <vector>
+#include <span>
 #include <dynaplex/vargroup.h>
 #include <dynaplex/rng.h>
 
@@ -45,6 +46,9 @@ namespace DynaPlex
 	private:
 		std::vector<double> translatedPMF{};
 		std::vector<double> cumulativePMF{};
+		//alias table for GetSamples, see OptimizeForSampling.
+		std::vector<double> aliasProb{};
+		std::vector<int64_t> aliasIndex{};
 		bool optimizedForSampling{ false };
 		int64_t min{ 0 };
 
@@ -65,6 +69,8 @@ namespace DynaPlex
 
 		static bool IsProbMassFunction(const std::vector<double>& PMF);
 
+		void BuildAliasTable();
+
 
 	public:
 
@@ -162,6 +168,17 @@ namespace DynaPlex
 		/// Returns a sample of the rv, using the rng as random number generator. 
 		int64_t GetSample(DynaPlex::RNG& rng) const;
 
+		/// Returns the sample that GetSample returns when the rng yields uniform, i.e. the smallest x with P(X<=x)>uniform, where uniform is in [0,1).
+		/// Enables drawing the uniforms for a number of samples at once, see DynaPlex::RNG::genUniforms.
+		int64_t GetSampleFromUniform(double uniform) const;
+
+		/**
+		 * Fills samples with independent samples of the rv, drawing the required random numbers from rng at once.
+		 * If OptimizeForSampling was called, samples are drawn from an alias table in constant time per sample, independent of the
+		 * number of values. Note that the samples then differ from those obtained by successive calls to GetSample with the same rng.
+		 */
+		void GetSamples(DynaPlex::RNG& rng, std::span<int64_t> samples) const;
+
 		/// Returns a sample x of the rv|x>=minimum_value. Uses the rng as random number generator. 
 		int64_t GetConditionalSample(DynaPlex::RNG& rng,int64_t minimum_value) const;
 
@@ -1,6 +1,7 @@
 #pragma once
 #include "dynaplex/dynaplex_model_includes.h"
 #include "dynaplex/modelling/discretedist.h"
+#include <optional>
 
 namespace DynaPlex::Models {
 	namespace joint_replenishment {/*must be consistent everywhere for complete mdp definition and associated policies and states (if not defined inline).*/
@@ -14,8 +15,17 @@ namespace DynaPlex::Models {
 			bool isNonStationary;
 			std::vector<double> initialForecast, initialSigma, volume, orderRate;
 			std::vector<std::vector<double>> demandProb;
-
-			// define an SKU class
+			// number of periods in the demand schedule; only used if isNonStationary
+			int64_t horizon;
+			// per-SKU order rate for each period of the horizon; only used if isNonStationary
+			std::vector<std::vector<double>> orderRateSchedule;
+			// compound demand distributions (occurrence and size combined), precomputed for sampling. One per SKU if
+			// stationary, else one per SKU and period, stored period-major: demandDist[period * nrProducts + product]
+			std::vector<DiscreteDist> demandDist;
+			// joint demand outcomes with probability below this threshold are dropped by EventProbabilities
+			double eventProbabilityThreshold;
+
+			// per-SKU record; only used to (de)serialize states, see State::ToVarGroup and GetState
 			struct SKU {
 				int64_t skuNumber;
 				double forecastedDemand;
@@ -23,14 +33,6 @@ namespace DynaPlex::Models {
 				double inventoryLevel;
 				std::vector<int64_t> orderQty;
 
-				// assign SKU features to a DynaPlex::Features object
-				void AddSKUToFeatures(DynaPlex::Features& feats) const {
-					feats.Add(forecastedDemand);
-					feats.Add(forecastDeviation);
-					feats.Add(inventoryLevel);
-					feats.Add(orderQty);
-				}
-
 				// converts SKU data into a DynaPlex::VarGroup object
 				DynaPlex::VarGroup ToVarGroup() const {
 					DynaPlex::VarGroup vars;
@@ -58,44 +60,115 @@ namespace DynaPlex::Models {
 				bool operator==(const SKU& other) const = default;
 			};
 
+			// if true, states accumulate KPIs during ModifyStateWithEvent; see KPIs
+			bool trackKPIs;
+
+			// KPIs accumulated over the periods of a trajectory. Empty unless trackKPIs; sum over trajectories with Add
+			struct KPIs {
+				int64_t periods = 0;
+				int64_t containers = 0; // periods in which a container was shipped
+				double usedCapacity = 0.0; // summed over shipped containers
+				double holdingCosts = 0.0;
+				double backorderCosts = 0.0;
+				double orderingCosts = 0.0;
+				// per SKU
+				std::vector<double> demand;
+				std::vector<double> demandMet; // demand met from on-hand inventory in the period it occurred
+				std::vector<double> backorders; // demand not met from on-hand inventory
+				std::vector<int64_t> orderCount; // number of containers that included the SKU
+				std::vector<int64_t> orderedQty;
+
+				KPIs() {}
+				explicit KPIs(int64_t nrProducts);
+				explicit KPIs(const DynaPlex::VarGroup& vars);
+				DynaPlex::VarGroup ToVarGroup() const;
+				void Add(const KPIs& other);
+				bool operator==(const KPIs& other) const = default;
+			};
+
 			// defines actionsList variable as a integer vector
 			std::vector<int64_t> actionsList;
 
 			struct State {
 				DynaPlex::StateCategory cat;
 
-				// defines SKUs as a vector
-				std::vector<SKU> SKUs;
+				// SKU data is stored as one contiguous array per field, indexed by skuNumber, 
+				// so that copying a state takes a fixed number of allocations regardless of nrProducts. 
+				std::vector<double> forecastedDemand;
+				std::vector<double> forecastDeviation;
+				std::vector<double> inventoryLevel;
+				// pipeline of in-transit orders as a single leadTime x nrProducts ring buffer; the row at pipelineHead
+				// arrives next, rows further along (wrapping around) arrive later. Rather than shifting the pipeline,
+				// each period the arriving row is cleared and pipelineHead advances, so it becomes the newest row.
+				std::vector<int64_t> orderQty;
+				int64_t pipelineHead;
+				int64_t leadTime;
+				// running total of orderQty per product, kept up to date with every order and arrival
+				std::vector<int64_t> inTransit;
 
 				double usedCapacity;
 				int64_t remainingEvents;
-				float periodOrderingCosts;
-				float periodBackorderCosts;
-				float periodHoldingCosts;
+				double periodOrderingCosts;
+				double periodBackorderCosts;
+				double periodHoldingCosts;
 				int64_t orderItem;
 				int64_t periodCount = 1;
+				KPIs kpis;
 				// float discountFactor;
 
+				int64_t NrProducts() const {
+					return static_cast<int64_t>(inventoryLevel.size());
+				}
+
+				// quantity of product that arrives k periods from now
+				int64_t& OrderQty(int64_t product, int64_t k) {
+					return orderQty[PipelineRow(k) * NrProducts() + product];
+				}
+				const int64_t& OrderQty(int64_t product, int64_t k) const {
+					return orderQty[PipelineRow(k) * NrProducts() + product];
+				}
+
+				// inventory level plus all in-transit orders
+				double InventoryPosition(int64_t product) const {
+					return inventoryLevel[product] + inTransit[product];
+				}
+
+				// physical row in orderQty that holds the orders arriving k periods from now
+				int64_t PipelineRow(int64_t k) const {
+					int64_t row = pipelineHead + k;
+					return row < leadTime ? row : row - leadTime;
+				}
+
 				// convert State object into a DynaPlex::VarGroup object
 				DynaPlex::VarGroup ToVarGroup() const;
 
-				// checks if two state objects are equal -- note; does not always work and can be removed 
-				bool operator==(const State& other) const = default;
+				// checks if two state objects are equal; pipelines are compared by arrival period, not by physical row
+				bool operator==(const State& other) const;
 			};
 
 			// enumeration class which defines a set of integer constants
 			enum class actionType :int64_t {
 				productSelection,
 				quantitySelection,
-				pass
+				pass,
+				productQuantitySelection // single-stage mode: product and quantity in one decision
 			};
 
 			// creates a structure to to represent specific actions with a number
 			struct actionClass {
 				actionType type;
 				int64_t number;
+				int64_t product = 0; // only used by productQuantitySelection; number is then the quantity
 			};
 
+			// if true, an order is a single decision that selects product and quantity together, instead of
+			// productSelection followed by quantitySelection. Halves the decision epochs per order.
+			bool singleStageActions;
+			// index of the pass action, in either action mode
+			int64_t PassAction() const;
+			// index of the action that orders quantity pallets of product; single-stage mode only
+			int64_t OrderAction(int64_t product, int64_t quantity) const;
+
 			// defines a vector to contain actions
 			std::vector<actionClass> actions;
 
@@ -105,10 +178,20 @@ namespace DynaPlex::Models {
 			// remainder of DynaPlex API
 			double ModifyStateWithAction(State&, int64_t action) const;
 			double ModifyStateWithEvent(State&, const Event&) const;
-			Event GetEvent(DynaPlex::RNG& rng) const;
+			Event GetEvent(const State&, DynaPlex::RNG& rng) const;
+			// fills event in place, so that the adapter can reuse one buffer instead of allocating per period
+			void GetEvent(const State&, DynaPlex::RNG& rng, Event& event) const;
+			// enumerates joint demand outcomes per SKU, pruning outcomes below eventProbabilityThreshold
+			std::vector<std::tuple<Event, double>> EventProbabilities(const State&) const;
+			// demand distribution of product in the period that state is in
+			const DiscreteDist& DemandDist(const State&, int64_t product) const;
 			DynaPlex::VarGroup GetStaticInfo() const;
 			DynaPlex::StateCategory GetStateCategory(const State&) const;
 			bool IsAllowedAction(const State& state, int64_t action) const;
+			// marks all actions for which IsAllowedAction holds in a single pass, skipping quantities that do not fit
+			void GetAllowedActions(const State& state, DynaPlex::ActionMask& mask) const;
+			// the only allowed action if there is exactly one, e.g. pass when no product fits; lets rollouts skip such decisions cheaply
+			std::optional<int64_t> TrivialAction(const State& state) const;
 			State GetInitialState() const;
 			State GetState(const VarGroup&) const;
 			void RegisterPolicies(DynaPlex::Erasure::PolicyRegistry<MDP>&) const;
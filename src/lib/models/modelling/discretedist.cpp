@@ -421,11 +421,18 @@ namespace DynaPlex
 		int64_t minResult = this->min + other.min;
 		int64_t maxResult = this->Max() + other.Max();
 		std::vector<double> PMFResult(static_cast<size_t>(maxResult - minResult + 1ll), 0.0);
+		const double* otherPMF = other.translatedPMF.data();
+		size_t otherSize = other.translatedPMF.size();
 		for (size_t i = 0; i < translatedPMF.size(); i++)
 		{
-			for (size_t j = 0; j < other.translatedPMF.size(); j++)
+			double prob = translatedPMF[i];
+			if (prob == 0.0)
+				continue;
+			//contiguous multiply-add over the other pmf, which the compiler vectorizes.
+			double* result = PMFResult.data() + i;
+			for (size_t j = 0; j < otherSize; j++)
 			{
-				PMFResult[i + j] += this->translatedPMF[i] * other.translatedPMF[j];
+				result[j] += prob * otherPMF[j];
 			}
 		}
 		Trim(PMFResult, minResult);
@@ -450,12 +457,7 @@ namespace DynaPlex
 		{
 			PMFResult[0] += translatedPMF[i];
 		}
-
-
-		for (int64_t i = delta + 1ll; i <= max - min; i++)
-		{
-			PMFResult[i - delta] = translatedPMF[i];
-		}
+		std::copy(translatedPMF.begin() + delta + 1ll, translatedPMF.end(), PMFResult.begin() + 1);
 		Trim(PMFResult, minResult);
 		return DiscreteDist(PMFResult, minResult);
 	}
@@ -483,7 +485,7 @@ namespace DynaPlex
 		int64_t max = Max();
 		for (i = min; i <= max; i++)
 		{
-			resProb -= ProbabilityAt(i);
+			resProb -= translatedPMF[i - min];
 			if (resProb < resProbTarget)
 			{
 				break;
@@ -766,23 +768,80 @@ namespace DynaPlex
 	void DiscreteDist::OptimizeForSampling() {
 		//if (translatedPMF.size() > 9)
 		{
+			cumulativePMF.clear();
 			cumulativePMF.reserve(translatedPMF.size());
 			double sum = 0.0;
 			for (const auto& p : translatedPMF) {
 				sum += p;
 				cumulativePMF.push_back(sum);
 			}
+			BuildAliasTable();
 			optimizedForSampling = true;
 		}
 	}
 
+	void DiscreteDist::BuildAliasTable() {
+		// Vose's method: every column i holds value i with probability aliasProb[i], and value aliasIndex[i] otherwise.
+		size_t n = translatedPMF.size();
+		aliasProb.assign(n, 1.0);
+		aliasIndex.resize(n);
+		std::vector<double> scaled(n);
+		std::vector<size_t> small, large;
+		for (size_t i = 0; i < n; i++) {
+			aliasIndex[i] = static_cast<int64_t>(i);
+			scaled[i] = translatedPMF[i] * static_cast<double>(n);
+			if (scaled[i] < 1.0)
+				small.push_back(i);
+			else
+				large.push_back(i);
+		}
+		while (!small.empty() && !large.empty()) {
+			size_t s = small.back();
+			small.pop_back();
+			size_t l = large.back();
+			aliasProb[s] = scaled[s];
+			aliasIndex[s] = static_cast<int64_t>(l);
+			scaled[l] -= 1.0 - scaled[s];
+			if (scaled[l] < 1.0) {
+				large.pop_back();
+				small.push_back(l);
+			}
+		}
+		// remaining columns are full, up to rounding in the scaled probabilities.
+	}
+
+	void DiscreteDist::GetSamples(DynaPlex::RNG& rng, std::span<int64_t> samples) const {
+		if (!optimizedForSampling) {
+			for (auto& sample : samples)
+				sample = GetSample(rng);
+			return;
+		}
+		// draw all uniforms at once; the samples span serves as buffer for their bits.
+		rng.genInts(samples);
+		size_t last = aliasProb.size() - 1;
+		double n = static_cast<double>(aliasProb.size());
+		for (auto& sample : samples) {
+			// one uniform selects both the column (integer part) and whether to take its alias (fractional part).
+			double scaled = XoshiroCpp::DoubleFromBits(static_cast<uint64_t>(sample)) * n;
+			size_t column = std::min(static_cast<size_t>(scaled), last);
+			double fraction = scaled - static_cast<double>(column);
+			sample = min + (fraction < aliasProb[column] ? static_cast<int64_t>(column) : aliasIndex[column]);
+		}
+	}
+
 	int64_t DiscreteDist::GetSample(DynaPlex::RNG& rng) const {
 		// Generate a uniform random number between 0 and 1
-		double randomValue = rng.genUniform();
+		return GetSampleFromUniform(rng.genUniform());
+	}
 
+	int64_t DiscreteDist::GetSampleFromUniform(double randomValue) const {
 		if (optimizedForSampling) {
-			// Use binary search on the cumulativePMF
-			auto it = std::lower_bound(cumulativePMF.begin(), cumulativePMF.end(), randomValue);
+			// Use binary search on the cumulativePMF for the first cumulative probability > randomValue, as in the linear search below
+			auto it = std::upper_bound(cumulativePMF.begin(), cumulativePMF.end(), randomValue);
+			if (it == cumulativePMF.end()) {
+				// only reachable through rounding in the cumulative sums
+				return Max();
+			}
 			size_t index = std::distance(cumulativePMF.begin(), it);
 			return min + static_cast<int64_t>(index);
 		}
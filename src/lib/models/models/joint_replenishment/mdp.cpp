@@ -3,6 +3,7 @@
 #include "dynaplex/erasure/mdpregistrar.h"
 #include "policies.h"
 #include <cmath>
+#include <algorithm>
 
 namespace DynaPlex::Models {
 	namespace joint_replenishment { /*keep this in line with id below and with namespace name in header*/
@@ -33,46 +34,67 @@ namespace DynaPlex::Models {
 			state.periodOrderingCosts = 0;
 			bool order = false;
 
-			for (int productID = 0; productID < nrProducts; productID++) {
-				auto& product = state.SKUs[productID];
-				auto demand = event[product.skuNumber];
-
-				// determine if container was ordered
-				if (product.orderQty[leadTime - 1] > 0) {
+			// determine if container was ordered
+			for (int64_t productID = 0; productID < nrProducts; productID++) {
+				auto ordered = state.OrderQty(productID, leadTime - 1);
+				if (ordered > 0) {
 					order = true;
+					if (trackKPIs) {
+						state.kpis.orderCount[productID] += 1;
+						state.kpis.orderedQty[productID] += ordered;
+					}
 				}
+			}
+			if (trackKPIs && order) {
+				state.kpis.containers += 1;
+				state.kpis.usedCapacity += state.usedCapacity;
+			}
 
-				// update inventory levels
-				product.inventoryLevel += product.orderQty[0] - demand;
-
-				// update orderQty array
-				for (size_t j = 0; j < leadTime - 1; ++j) {
-					product.orderQty[j] = product.orderQty[j + 1];
+			// update inventory levels; the orders at the head of the pipeline arrive
+			int64_t* arriving = state.orderQty.data() + state.pipelineHead * nrProducts;
+			for (int64_t productID = 0; productID < nrProducts; productID++) {
+				if (trackKPIs) {
+					double demandMet = std::clamp(state.inventoryLevel[productID] + arriving[productID], 0.0, event[productID]);
+					state.kpis.demand[productID] += event[productID];
+					state.kpis.demandMet[productID] += demandMet;
+					state.kpis.backorders[productID] += event[productID] - demandMet;
 				}
-				product.orderQty[leadTime - 1] = 0; // set last element equal to zero
+				state.inventoryLevel[productID] += arriving[productID] - event[productID];
+				state.inTransit[productID] -= arriving[productID];
+				arriving[productID] = 0;
+			}
+
+			// move in transit inventory one step ahead in time; the cleared row becomes the newest row
+			state.pipelineHead = state.PipelineRow(1);
+
+			for (int64_t productID = 0; productID < nrProducts; productID++) {
+				auto demand = event[productID];
+				auto& forecastedDemand = state.forecastedDemand[productID];
+				auto& forecastDeviation = state.forecastDeviation[productID];
+				auto inventoryLevel = state.inventoryLevel[productID];
 
 				// update forecast
-				product.forecastedDemand = product.forecastedDemand / leadTime; // correct to single-period forecast
-				product.forecastDeviation = product.forecastDeviation / sqrt(leadTime);
+				forecastedDemand = forecastedDemand / leadTime; // correct to single-period forecast
+				forecastDeviation = forecastDeviation / sqrt(leadTime);
 
-				product.forecastDeviation = sqrt(smoothingParameter * pow(demand - product.forecastedDemand, 2) +
-					(1.0 - smoothingParameter) * product.forecastDeviation * product.forecastDeviation);
+				forecastDeviation = sqrt(smoothingParameter * pow(demand - forecastedDemand, 2) +
+					(1.0 - smoothingParameter) * forecastDeviation * forecastDeviation);
 
-				product.forecastedDemand = smoothingParameter * demand +
-					(1.0 - smoothingParameter) * product.forecastedDemand;
+				forecastedDemand = smoothingParameter * demand +
+					(1.0 - smoothingParameter) * forecastedDemand;
 
-				product.forecastedDemand = product.forecastedDemand * leadTime; // convert back to forecast over lead time duration
-				product.forecastDeviation = product.forecastDeviation * sqrt(leadTime);
+				forecastedDemand = forecastedDemand * leadTime; // convert back to forecast over lead time duration
+				forecastDeviation = forecastDeviation * sqrt(leadTime);
 
 				// calculate reward
-				if (product.inventoryLevel >= 0) {
-					reward += holdingCost * std::ceil(product.inventoryLevel); // pallet costs are per pallet space, thus rounded up
-					state.periodHoldingCosts += holdingCost * std::ceil(product.inventoryLevel);
+				if (inventoryLevel >= 0) {
+					reward += holdingCost * std::ceil(inventoryLevel); // pallet costs are per pallet space, thus rounded up
+					state.periodHoldingCosts += holdingCost * std::ceil(inventoryLevel);
 				}
 				else {
-					reward += penaltyCost * (-product.inventoryLevel);
-					state.periodBackorderCosts += penaltyCost * (-product.inventoryLevel);
-					// product.inventoryLevel = 0; // lost sales instead of backordering
+					reward += penaltyCost * (-inventoryLevel);
+					state.periodBackorderCosts += penaltyCost * (-inventoryLevel);
+					// inventoryLevel = 0; // lost sales instead of backordering
 				}
 			}
 
@@ -82,10 +104,16 @@ namespace DynaPlex::Models {
 				reward += orderCost;
 			}
 
+			if (trackKPIs) {
+				state.kpis.periods += 1;
+				state.kpis.holdingCosts += state.periodHoldingCosts;
+				state.kpis.backorderCosts += state.periodBackorderCosts;
+				state.kpis.orderingCosts += state.periodOrderingCosts;
+			}
+
 			// reset for new period
 			state.usedCapacity = 0;
 
-			// move in transit inventory one step ahead in time
 			state.cat = StateCategory::AwaitAction(0);
 
 			if (isNonStationary) {
@@ -111,7 +139,7 @@ namespace DynaPlex::Models {
 				std::cout << "this action (" << action << ") should not be allowed.";
 				throw DynaPlex::Error("joint_replenishment :: action not allowed; state.usedCapacity");
 			}
-			auto& [type, index] = actions[action]; // action types: (1) product selection and (2) quantitiy selection; index refers to decision of action type!
+			auto& [type, index, product] = actions[action]; // action types: (1) product selection and (2) quantitiy selection; index refers to decision of action type!
 			double remaining = capacity - state.usedCapacity;
 
 			switch (type) {
@@ -136,13 +164,24 @@ namespace DynaPlex::Models {
 			}
 
 			case actionType::quantitySelection: {
-				state.SKUs[state.orderItem].orderQty[leadTime - 1] = index; // update state to reflect chosen orderQty
+				state.OrderQty(state.orderItem, leadTime - 1) = index; // update state to reflect chosen orderQty
+				state.inTransit[state.orderItem] += index;
 				state.cat = StateCategory::AwaitAction(0); // productSelection
 				state.usedCapacity += index * volume[state.orderItem]; // convert number of items ordered into volume
 				
 				return 0.0;
 			}
 
+			case actionType::productQuantitySelection: {
+				state.OrderQty(product, leadTime - 1) = index;
+				state.inTransit[product] += index;
+				state.usedCapacity += index * volume[product];
+				state.orderItem = product;
+				state.cat = StateCategory::AwaitAction(0); // remains at the single decision stage
+
+				return 0.0;
+			}
+
 			default:
 				throw DynaPlex::Error("joint_replenishment :: invalid type in IsAllowedAction");
 			}
@@ -155,39 +194,159 @@ namespace DynaPlex::Models {
 			DynaPlex::VarGroup vars;
 			vars.Add("cat", cat);
 			vars.Add("usedCapacity", usedCapacity);
+
+			// SKUs are exposed per product, independent of the internal layout
+			std::vector<SKU> SKUs(NrProducts());
+			for (int64_t i = 0; i < NrProducts(); i++) {
+				auto& item = SKUs[i];
+				item.skuNumber = i;
+				item.forecastedDemand = forecastedDemand[i];
+				item.forecastDeviation = forecastDeviation[i];
+				item.inventoryLevel = inventoryLevel[i];
+				item.orderQty.resize(leadTime);
+				for (int64_t k = 0; k < leadTime; k++) {
+					item.orderQty[k] = OrderQty(i, k);
+				}
+			}
 			vars.Add("SKUs", SKUs);
 			vars.Add("remainingEvents", remainingEvents);
 			vars.Add("orderItem", orderItem);
+			vars.Add("periodCount", periodCount);
+			vars.Add("periodOrderingCosts", periodOrderingCosts);
+			vars.Add("periodBackorderCosts", periodBackorderCosts);
+			vars.Add("periodHoldingCosts", periodHoldingCosts);
+			if (!kpis.demand.empty()) {
+				vars.Add("kpis", kpis.ToVarGroup());
+			}
+			return vars;
+		}
+
+		MDP::KPIs::KPIs(int64_t nrProducts)
+			: demand(nrProducts, 0.0), demandMet(nrProducts, 0.0), backorders(nrProducts, 0.0),
+			orderCount(nrProducts, 0), orderedQty(nrProducts, 0) {
+		}
+
+		MDP::KPIs::KPIs(const DynaPlex::VarGroup& vars) {
+			vars.Get("periods", periods);
+			vars.Get("containers", containers);
+			vars.Get("usedCapacity", usedCapacity);
+			vars.Get("holdingCosts", holdingCosts);
+			vars.Get("backorderCosts", backorderCosts);
+			vars.Get("orderingCosts", orderingCosts);
+			vars.Get("demand", demand);
+			vars.Get("demandMet", demandMet);
+			vars.Get("backorders", backorders);
+			vars.Get("orderCount", orderCount);
+			vars.Get("orderedQty", orderedQty);
+		}
+
+		DynaPlex::VarGroup MDP::KPIs::ToVarGroup() const {
+			DynaPlex::VarGroup vars;
+			vars.Add("periods", periods);
+			vars.Add("containers", containers);
+			vars.Add("usedCapacity", usedCapacity);
+			vars.Add("holdingCosts", holdingCosts);
+			vars.Add("backorderCosts", backorderCosts);
+			vars.Add("orderingCosts", orderingCosts);
+			vars.Add("demand", demand);
+			vars.Add("demandMet", demandMet);
+			vars.Add("backorders", backorders);
+			vars.Add("orderCount", orderCount);
+			vars.Add("orderedQty", orderedQty);
 			return vars;
 		}
 
+		void MDP::KPIs::Add(const KPIs& other) {
+			if (demand.empty()) {
+				*this = KPIs(static_cast<int64_t>(other.demand.size()));
+			}
+			if (other.demand.size() != demand.size()) {
+				throw DynaPlex::Error("joint_replenishment :: cannot add KPIs with a different number of items");
+			}
+			periods += other.periods;
+			containers += other.containers;
+			usedCapacity += other.usedCapacity;
+			holdingCosts += other.holdingCosts;
+			backorderCosts += other.backorderCosts;
+			orderingCosts += other.orderingCosts;
+			for (size_t i = 0; i < demand.size(); i++) {
+				demand[i] += other.demand[i];
+				demandMet[i] += other.demandMet[i];
+				backorders[i] += other.backorders[i];
+				orderCount[i] += other.orderCount[i];
+				orderedQty[i] += other.orderedQty[i];
+			}
+		}
+
+		bool MDP::State::operator==(const State& other) const {
+			if (NrProducts() != other.NrProducts() || leadTime != other.leadTime) {
+				return false;
+			}
+			for (int64_t i = 0; i < NrProducts(); i++) {
+				for (int64_t k = 0; k < leadTime; k++) {
+					if (OrderQty(i, k) != other.OrderQty(i, k)) {
+						return false;
+					}
+				}
+			}
+			return cat == other.cat && forecastedDemand == other.forecastedDemand && forecastDeviation == other.forecastDeviation
+				&& inventoryLevel == other.inventoryLevel && inTransit == other.inTransit && usedCapacity == other.usedCapacity
+				&& remainingEvents == other.remainingEvents && periodOrderingCosts == other.periodOrderingCosts
+				&& periodBackorderCosts == other.periodBackorderCosts && periodHoldingCosts == other.periodHoldingCosts
+				&& orderItem == other.orderItem && periodCount == other.periodCount && kpis == other.kpis;
+		}
+
 		// get state information
 		MDP::State MDP::GetState(const VarGroup& vars) const {
 			State state{};
 			vars.Get("cat", state.cat);
 			vars.Get("usedCapacity", state.usedCapacity);
-			vars.Get("SKUs", state.SKUs);
+
+			std::vector<SKU> SKUs;
+			vars.Get("SKUs", SKUs);
+			if (SKUs.size() != nrProducts) {
+				throw DynaPlex::Error("joint_replenishment :: number of SKUs in state does not match the number of items");
+			}
+			state.forecastedDemand.resize(nrProducts);
+			state.forecastDeviation.resize(nrProducts);
+			state.inventoryLevel.resize(nrProducts);
+			state.orderQty.resize(nrProducts * leadTime);
+			state.pipelineHead = 0;
+			state.leadTime = leadTime;
+			state.inTransit.assign(nrProducts, 0);
+			for (const auto& item : SKUs) {
+				if (item.skuNumber < 0 || item.skuNumber >= nrProducts || item.orderQty.size() != leadTime) {
+					throw DynaPlex::Error("joint_replenishment :: SKU in state is inconsistent with nrProducts or leadTime");
+				}
+				state.forecastedDemand[item.skuNumber] = item.forecastedDemand;
+				state.forecastDeviation[item.skuNumber] = item.forecastDeviation;
+				state.inventoryLevel[item.skuNumber] = item.inventoryLevel;
+				for (int64_t k = 0; k < leadTime; k++) {
+					state.OrderQty(item.skuNumber, k) = item.orderQty[k];
+					state.inTransit[item.skuNumber] += item.orderQty[k];
+				}
+			}
 			vars.Get("remainingEvents", state.remainingEvents);
 			vars.Get("orderItem", state.orderItem);
+			//states saved before these fields were stored do not have them:
+			vars.GetOrDefault("periodCount", state.periodCount, 1);
+			vars.GetOrDefault("periodOrderingCosts", state.periodOrderingCosts, 0.0);
+			vars.GetOrDefault("periodBackorderCosts", state.periodBackorderCosts, 0.0);
+			vars.GetOrDefault("periodHoldingCosts", state.periodHoldingCosts, 0.0);
+			if (vars.HasKey("kpis", false)) {
+				DynaPlex::VarGroup kpiVars;
+				vars.Get("kpis", kpiVars);
+				state.kpis = KPIs(kpiVars);
+			}
+			else if (trackKPIs) {
+				state.kpis = KPIs(nrProducts);
+			}
 			return state;
 		}
 
 		// initialise state variables at start of horizon
 		MDP::State MDP::GetInitialState() const {
 			State state{};
-			state.SKUs = std::vector<SKU>{};
-			state.SKUs.reserve(nrProducts);
-
-			// creates multiple SKU objects equal to nrProducts
-			for (size_t i = 0; i < nrProducts; i++) {
-				SKU item{};
-				item.skuNumber = i;
-				item.forecastedDemand = initialForecast[i];
-				item.forecastDeviation = initialSigma[i];
-				item.inventoryLevel = std::ceil(initialForecast[i] + 1.282 * initialSigma[i]); // base stock 90%; rounded up
-				item.orderQty.resize(leadTime, 0);
-				state.SKUs.push_back(item);
-			}
 
 			// check that the number of elements in input arrays match nrProducts
 			if (initialForecast.size() != nrProducts) {
@@ -203,12 +362,29 @@ namespace DynaPlex::Models {
 				throw DynaPlex::Error("joint_replenishment :: pallet volume data does not match the number of items");
 			}
 
+			state.forecastedDemand = initialForecast;
+			state.forecastDeviation = initialSigma;
+			state.inventoryLevel.resize(nrProducts);
+			for (int64_t i = 0; i < nrProducts; i++) {
+				state.inventoryLevel[i] = std::ceil(initialForecast[i] + 1.282 * initialSigma[i]); // base stock 90%; rounded up
+			}
+			state.orderQty.assign(nrProducts * leadTime, 0);
+			state.pipelineHead = 0;
+			state.leadTime = leadTime;
+			state.inTransit.assign(nrProducts, 0);
+
 			// start by selecting a product to produce
 			state.cat = StateCategory::AwaitAction(0);
 
 			state.orderItem = 0;
 			state.usedCapacity = 0;
-			state.remainingEvents = 100;
+			state.remainingEvents = isNonStationary ? horizon : 100; // only counts down if isNonStationary
+			state.periodOrderingCosts = 0;
+			state.periodBackorderCosts = 0;
+			state.periodHoldingCosts = 0;
+			if (trackKPIs) {
+				state.kpis = KPIs(nrProducts);
+			}
 
 			return state;
 		}
@@ -231,6 +407,18 @@ namespace DynaPlex::Models {
 			config.Get("nrProducts", nrProducts);
 			config.Get("isNonStationary", isNonStationary);
 			config.Get("maxPallets", maxPallets);
+			if (config.HasKey("singleStageActions"))
+				config.Get("singleStageActions", singleStageActions);
+			else
+				singleStageActions = false;
+			if (config.HasKey("trackKPIs"))
+				config.Get("trackKPIs", trackKPIs);
+			else
+				trackKPIs = false;
+			if (config.HasKey("eventProbabilityThreshold"))
+				config.Get("eventProbabilityThreshold", eventProbabilityThreshold);
+			else
+				eventProbabilityThreshold = 1e-6;
 
 			// build demandProb 2D array
 			for (int64_t i = 0; i < nrProducts; i++) {
@@ -239,51 +427,175 @@ namespace DynaPlex::Models {
 				demandProb.push_back(buildDemandArray);
 			}
 
+			if (isNonStationary) {
+				// seasonal or promotional profiles: the order rate of each SKU is given per period
+				for (int64_t i = 0; i < nrProducts; i++) {
+					std::vector<double> schedule;
+					config.Get("orderRateSchedule_" + std::to_string(i), schedule);
+					orderRateSchedule.push_back(schedule);
+				}
+				horizon = orderRateSchedule.empty() ? 0 : static_cast<int64_t>(orderRateSchedule[0].size());
+				if (horizon == 0) {
+					throw DynaPlex::Error("joint_replenishment :: non stationary demand requires a non-empty orderRateSchedule");
+				}
+				for (const auto& schedule : orderRateSchedule) {
+					if (schedule.size() != horizon) {
+						throw DynaPlex::Error("joint_replenishment :: orderRateSchedule lengths differ between items");
+					}
+				}
+			}
+			else {
+				horizon = 0;
+			}
+
+			// compound Poisson demand per period: no order with probability 1 - orderRate, otherwise an order
+			// of k pallets with probability orderRate * demandProb[k-1]. Built once so that GetEvent only samples.
+			auto compoundDist = [&](int64_t product, double rate) {
+				std::vector<double> compoundProb(demandProb[product].size() + 1);
+				compoundProb[0] = 1.0 - rate;
+				for (size_t k = 0; k < demandProb[product].size(); k++) {
+					compoundProb[k + 1] = rate * demandProb[product][k];
+				}
+				auto dist = DiscreteDist::GetCustomDist(compoundProb, 0);
+				dist.OptimizeForSampling();
+				return dist;
+			};
+			if (isNonStationary) {
+				demandDist.reserve(horizon * nrProducts);
+				for (int64_t period = 0; period < horizon; period++) {
+					for (int64_t i = 0; i < nrProducts; i++) {
+						demandDist.push_back(compoundDist(i, orderRateSchedule[i][period]));
+					}
+				}
+			}
+			else {
+				demandDist.reserve(nrProducts);
+				for (int64_t i = 0; i < nrProducts; i++) {
+					demandDist.push_back(compoundDist(i, orderRate[i]));
+				}
+			}
+
 			// create actions list
-			for (int64_t i = 0; i < nrProducts; i++) {
-				actions.push_back({ actionType::productSelection,i });
-				actionsList.push_back(i);
+			if (singleStageActions) {
+				for (int64_t i = 0; i < nrProducts; i++) {
+					for (int64_t j = 1; j <= maxPallets; j++) {
+						actions.push_back({ actionType::productQuantitySelection, j, i });
+						actionsList.push_back(j);
+					}
+				}
 			}
+			else {
+				for (int64_t i = 0; i < nrProducts; i++) {
+					actions.push_back({ actionType::productSelection,i });
+					actionsList.push_back(i);
+				}
 
-			for (int64_t i = 1; i <= maxPallets; i++) {
-				actionsList.push_back(i);
-				actions.push_back({ actionType::quantitySelection, i });
+				for (int64_t i = 1; i <= maxPallets; i++) {
+					actionsList.push_back(i);
+					actions.push_back({ actionType::quantitySelection, i });
+				}
 			}
 
 			actions.push_back({ actionType::pass,0 });
 			actionsList.push_back(0);
 		}
 
+		int64_t MDP::PassAction() const {
+			return static_cast<int64_t>(actions.size()) - 1;
+		}
+
+		int64_t MDP::OrderAction(int64_t product, int64_t quantity) const {
+			if (!singleStageActions) {
+				throw DynaPlex::Error("joint_replenishment :: OrderAction requires singleStageActions");
+			}
+			if (quantity < 1 || quantity > maxPallets) {
+				throw DynaPlex::Error("joint_replenishment :: order quantity outside of [1, maxPallets]");
+			}
+			return product * maxPallets + quantity - 1;
+		}
+
+		const DiscreteDist& MDP::DemandDist(const State& state, int64_t product) const {
+			if (!isNonStationary) {
+				return demandDist[product];
+			}
+			int64_t period = state.periodCount - 1; // periodCount starts at 1
+			if (period < 0 || period >= horizon) {
+				throw DynaPlex::Error("joint_replenishment :: periodCount outside of the demand schedule");
+			}
+			return demandDist[period * nrProducts + product];
+		}
+
 		// generate demand vector
-		MDP::Event MDP::GetEvent(RNG& rng) const {
-			// generate demand for each product
-			std::vector<double> demandVector; // demand expressed in partial pallets
-			demandVector.reserve(nrProducts);
-
-			for (int64_t product = 0; product < nrProducts; ++product) { // simulates compound poisson demand for each product
-				double demand;
-
-				// simulate compound Poisson demand
-				if (DiscreteDist::GetCustomDist({ 1 - orderRate[product], orderRate[product] }).GetSample(rng) == 1) {
-					if (isNonStationary) {
-						throw DynaPlex::Error("joint_replenishment :: non stationary demand not implemented");
-					}
-					else {
-						demand = DiscreteDist::GetCustomDist(demandProb[product], 1).GetSample(rng);
-					}
-				}
-				else {
-					demand = 0;
+		MDP::Event MDP::GetEvent(const State& state, RNG& rng) const {
+			Event demandVector;
+			GetEvent(state, rng, demandVector);
+			return demandVector;
+		}
+
+		void MDP::GetEvent(const State& state, RNG& rng, Event& demandVector) const {
+			// generate demand for each product, expressed in partial pallets.
+			// resize does not reallocate when the buffer is reused.
+			demandVector.resize(nrProducts);
+
+			// draw the uniforms for all products at once into the buffer, and then replace each by a draw
+			// from the compound demand distribution of the product.
+			rng.genUniforms(demandVector);
+			for (int64_t product = 0; product < nrProducts; ++product) {
+				demandVector[product] = static_cast<double>(DemandDist(state, product).GetSampleFromUniform(demandVector[product]));
+			}
+		}
+
+		std::vector<std::tuple<MDP::Event, double>> MDP::EventProbabilities(const State& state) const {
+			// demand is independent across SKUs, so the joint probability of an outcome is the product of the
+			// per-SKU probabilities. Outcomes are sorted by decreasing probability, such that the depth-first
+			// enumeration below can stop as soon as a partial product drops below the threshold.
+			std::vector<std::vector<DiscreteDist::QtyProb>> outcomes(nrProducts);
+			for (int64_t product = 0; product < nrProducts; ++product) {
+				for (const auto& [qty, prob] : DemandDist(state, product)) {
+					if (prob > 0.0)
+						outcomes[product].emplace_back(qty, prob);
 				}
-				demandVector.push_back(demand);
+				std::sort(outcomes[product].begin(), outcomes[product].end(),
+					[](const auto& a, const auto& b) { return std::get<1>(a) > std::get<1>(b); });
 			}
 
-			return demandVector;
+			std::vector<std::tuple<Event, double>> eventProbs;
+			Event demandVector(nrProducts, 0.0);
+			double retainedProb = 0.0;
+			auto enumerate = [&](auto& self, int64_t product, double prob) -> void {
+				if (product == nrProducts) {
+					eventProbs.emplace_back(demandVector, prob);
+					retainedProb += prob;
+					return;
+				}
+				for (const auto& [qty, qtyProb] : outcomes[product]) {
+					double jointProb = prob * qtyProb;
+					if (jointProb < eventProbabilityThreshold)
+						break;
+					demandVector[product] = static_cast<double>(qty);
+					self(self, product + 1, jointProb);
+				}
+			};
+			enumerate(enumerate, 0, 1.0);
+
+			if (eventProbs.empty()) {
+				throw DynaPlex::Error("joint_replenishment :: eventProbabilityThreshold prunes all demand outcomes");
+			}
+			// rescale so that the retained outcomes form a distribution
+			for (auto& [event, prob] : eventProbs) {
+				prob /= retainedProb;
+			}
+			return eventProbs;
 		}
 
 		void MDP::GetFeatures(const State& state, DynaPlex::Features& features)const {
-			for (size_t i = 0; i < state.SKUs.size();i++) {
-				state.SKUs[i].AddSKUToFeatures(features);
+			for (int64_t i = 0; i < nrProducts; i++) {
+				features.Add(state.forecastedDemand[i]);
+				features.Add(state.forecastDeviation[i]);
+				features.Add(state.inventoryLevel[i]);
+				for (int64_t k = 0; k < leadTime; k++) {
+					features.Add(state.OrderQty(i, k));
+				}
 			}
 
 			features.Add(state.usedCapacity);
@@ -313,7 +625,7 @@ namespace DynaPlex::Models {
 			}
 
 			// retreive type, index, currentDecision, remaining data; init enoughSpace
-			auto& [type, index] = actions[action];
+			auto& [type, index, product] = actions[action];
 			auto currentDecision = state.cat.Index(); // 0 = productSelection; 1 = quantitySelection
 			double remaining = capacity - state.usedCapacity;
 
@@ -336,7 +648,7 @@ namespace DynaPlex::Models {
 					return false;
 				}
 
-				if (state.SKUs[index].orderQty[leadTime - 1] != 0) {
+				if (state.OrderQty(index, leadTime - 1) != 0) {
 					return false;
 				}
 
@@ -351,17 +663,88 @@ namespace DynaPlex::Models {
 					return false;
 				}
 
-				if (state.SKUs[state.orderItem].orderQty[leadTime - 1] != 0) {
+				if (state.OrderQty(state.orderItem, leadTime - 1) != 0) {
 					return false;
 				}
 
 				return true; // returns true if current decision is quantitySelection, item not previously ordered
 			}
+			case actionType::productQuantitySelection: {
+				if (volume[product] * index > remaining) {
+					return false;
+				}
+
+				if (currentDecision != 0) {
+					return false;
+				}
+
+				if (state.OrderQty(product, leadTime - 1) != 0) {
+					return false;
+				}
+
+				return true; // returns true if order fits and product not previously ordered this period
+			}
 			default:
 				throw DynaPlex::Error("joint_replenishment :: invalid type in IsAllowedAction");
 			}
 		}
 
+		void MDP::GetAllowedActions(const State& state, DynaPlex::ActionMask& mask) const {
+			auto currentDecision = state.cat.Index(); // 0 = productSelection; 1 = quantitySelection
+			double remaining = capacity - state.usedCapacity;
+
+			// marks order quantities 1, 2, ... of product, as long as they fit in the remaining space
+			auto allowQuantities = [&](int64_t product, int64_t firstAction) {
+				if (state.OrderQty(product, leadTime - 1) != 0) {
+					return;
+				}
+				for (int64_t quantity = 1; quantity <= maxPallets && !(volume[product] * quantity > remaining); quantity++) {
+					mask.Allow(firstAction + quantity - 1);
+				}
+			};
+
+			if (currentDecision == 0) {
+				for (int64_t product = 0; product < nrProducts; product++) {
+					if (singleStageActions) {
+						allowQuantities(product, OrderAction(product, 1));
+					}
+					else if (!(volume[product] > remaining) && state.OrderQty(product, leadTime - 1) == 0) {
+						mask.Allow(product);
+					}
+				}
+				mask.Allow(PassAction());
+			}
+			else if (currentDecision == 1 && !singleStageActions) {
+				allowQuantities(state.orderItem, nrProducts);
+			}
+		}
+
+		std::optional<int64_t> MDP::TrivialAction(const State& state) const {
+			auto currentDecision = state.cat.Index(); // 0 = productSelection; 1 = quantitySelection
+			double remaining = capacity - state.usedCapacity;
+
+			if (currentDecision == 0) {
+				// pass is always allowed; the decision is trivial if no product can be ordered
+				for (int64_t product = 0; product < nrProducts; product++) {
+					if (!(volume[product] > remaining) && state.OrderQty(product, leadTime - 1) == 0) {
+						return std::nullopt;
+					}
+				}
+				return PassAction();
+			}
+			else if (currentDecision == 1 && !singleStageActions) {
+				// trivial if a single pallet of the selected product fits, but two do not
+				int64_t product = state.orderItem;
+				if (state.OrderQty(product, leadTime - 1) != 0 || volume[product] > remaining) {
+					return std::nullopt;
+				}
+				if (maxPallets == 1 || volume[product] * 2 > remaining) {
+					return nrProducts; // quantitySelection of one pallet
+				}
+			}
+			return std::nullopt;
+		}
+
 		void Register(DynaPlex::Registry& registry) {
 			DynaPlex::Erasure::MDPRegistrar<MDP>::RegisterModel("joint_replenishment", "Joint replenishment of items for an MSc Thesis at Ahold Delhaize", registry);
 		}
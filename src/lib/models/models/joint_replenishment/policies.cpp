@@ -1,11 +1,61 @@
 #include "policies.h"
 #include "dynaplex/models/joint_replenishment/mdp.h"
-#include <cstdlib>
 #include "dynaplex/error.h"
 
 namespace DynaPlex::Models {
 	namespace joint_replenishment  { /*keep this namespace name in line with the name space in which the mdp corresponding to this policy is defined*/
-	
+
+		namespace {
+			// draws uniformly among the products for which isCandidate holds, without building a list of candidates.
+			// returns -1 if there is no candidate; uses a single draw from rng otherwise.
+			template <typename t_Predicate>
+			int64_t DrawCandidate(int64_t nrProducts, const t_Predicate& isCandidate, DynaPlex::RNG& rng) {
+				int64_t count = 0;
+				for (int64_t product = 0; product < nrProducts; product++) {
+					if (isCandidate(product)) {
+						count++;
+					}
+				}
+				if (count == 0) {
+					return -1;
+				}
+				int64_t target = static_cast<int64_t>(rng.genUniform() * count);
+				for (int64_t product = 0; product < nrProducts; product++) {
+					if (isCandidate(product) && target-- == 0) {
+						return product;
+					}
+				}
+				return -1;
+			}
+
+			// whether product can be ordered up to orderUpToLevel: the quantity is a valid order of 1 to maxPallets pallets that fits in the container
+			bool CanOrderUpTo(const MDP& mdp, const MDP::State& state, int64_t product, int64_t orderUpToLevel) {
+				int64_t quantity = orderUpToLevel - static_cast<int64_t>(state.InventoryPosition(product));
+				float totalOrderQuantity = state.usedCapacity + quantity * mdp.volume[product];
+				return quantity >= 1 && quantity <= mdp.maxPallets && totalOrderQuantity <= mdp.capacity;
+			}
+
+			// action that orders up to orderUpToLevel for the product in quantitySelection, or passes if it does not fit
+			int64_t QuantityAction(const MDP& mdp, const MDP::State& state, int64_t orderUpToLevel) {
+				int64_t inventoryPosition = static_cast<int64_t>(state.InventoryPosition(state.orderItem));
+				int64_t quantity = orderUpToLevel - inventoryPosition;
+
+				if (quantity * mdp.volume[state.orderItem] + state.usedCapacity > mdp.capacity) {
+					return mdp.PassAction();
+				}
+				return mdp.nrProducts + quantity - 1;
+			}
+
+			// action that selects product; in single-stage mode, the order-up-to quantity is chosen in the same decision
+			int64_t ProductAction(const MDP& mdp, const MDP::State& state, int64_t product, int64_t orderUpToLevel) {
+				if (mdp.singleStageActions) {
+					int64_t inventoryPosition = static_cast<int64_t>(state.InventoryPosition(product));
+					return mdp.OrderAction(product, orderUpToLevel - inventoryPosition);
+				}
+				return product;
+			}
+		}
+
 		canOrderPolicy::canOrderPolicy(std::shared_ptr<const MDP> mdp, const VarGroup& config)
 			:mdp{ mdp } {
 			config.Get("reorderPoint", reorderPoint);
@@ -13,93 +63,45 @@ namespace DynaPlex::Models {
 			config.Get("orderUpToLevel", orderUpToLevel);
 		}
 
-		int64_t canOrderPolicy::GetAction(const MDP::State& state) const {
-			MDP::actionClass actionSelected{};
-			int64_t actionIndex; // refers to the placement of action on actionList
-			std::vector<int64_t> productsAllowed, inventoryPosition(mdp->nrProducts);
-			float totalOrderQuantity;
+		int64_t canOrderPolicy::GetAction(const MDP::State& state, DynaPlex::RNG& rng) const {
 
 			if (state.cat.Index() == 0) { // product selection
 
+				// an order is triggered if any item is at or below its reorder point
 				bool order = false;
 				for (int64_t product = 0; product < mdp->nrProducts; ++product) {
-
-					// calculate inventory position
-					inventoryPosition[product] = state.SKUs[product].inventoryLevel;
-					for (int64_t i = 0; i < mdp->leadTime;i++) {
-						inventoryPosition[product] += state.SKUs[product].orderQty[i];
-					}
-
-					// check if an item tirggers
-					if (inventoryPosition[product] <= reorderPoint[product]) {
+					if (static_cast<int64_t>(state.InventoryPosition(product)) <= reorderPoint[product]) {
 						order = true;
-					}
-				}
-
-				if (order == true) {
-
-					// check which products have not already been ordered that need to be
-					for (int64_t product = 0; product < mdp->nrProducts; product++) {
-
-						totalOrderQuantity = state.usedCapacity + (orderUpToLevel[product] - inventoryPosition[product]) * mdp->volume[product];
-
-						if (state.SKUs[product].orderQty[mdp->leadTime - 1] == 0 && inventoryPosition[product] <= canOrderPoint[product] && totalOrderQuantity <= mdp->capacity) {
-							productsAllowed.push_back(product);
-						}
-					}
-
-					// if all products have been ordered already, move onto new period
-					if (productsAllowed.size() == 0) {
-						actionSelected.type = MDP::actionType::pass; // always define (1) action type and (2) decision of action
-						actionSelected.number = 0;
-						actionIndex = mdp->nrProducts + mdp->maxPallets;
-					}
-
-					else {
-						actionSelected.type = MDP::actionType::productSelection;
-						int randomIndex = std::rand() % productsAllowed.size();
-						actionSelected.number = productsAllowed[randomIndex];
-						actionIndex = actionSelected.number;
+						break;
 					}
 				}
 
 				// no order placed
-				else { 
-					actionSelected.type = MDP::actionType::pass;
-					actionSelected.number = 0;
-					actionIndex = mdp->nrProducts + mdp->maxPallets;
+				if (!order) {
+					return mdp->PassAction();
 				}
-			}
-			
-			else if (state.cat.Index() == 1) { // quantity selection
 
-				// calculate inventory position
-				for (int64_t product = 0; product < mdp->nrProducts; product++) {
+				// products that have not already been ordered, are at or below their can-order point and can be ordered up to their level
+				auto isCandidate = [&](int64_t product) {
+					int64_t inventoryPosition = static_cast<int64_t>(state.InventoryPosition(product));
+					return state.OrderQty(product, mdp->leadTime - 1) == 0 && inventoryPosition <= canOrderPoint[product] && CanOrderUpTo(*mdp, state, product, orderUpToLevel[product]);
+				};
+				int64_t product = DrawCandidate(mdp->nrProducts, isCandidate, rng);
 
-					inventoryPosition[product] = state.SKUs[product].inventoryLevel;
-					for (int64_t i = 0; i < mdp->leadTime;i++) {
-						inventoryPosition[product] += state.SKUs[product].orderQty[i];
-					}
+				// if all products have been ordered already, move onto new period
+				if (product < 0) {
+					return mdp->PassAction();
 				}
+				return ProductAction(*mdp, state, product, orderUpToLevel[product]);
+			}
 
-				actionSelected.type = MDP::actionType::quantitySelection;
-				actionSelected.number = orderUpToLevel[state.orderItem] - inventoryPosition[state.orderItem];
-				
-				if (actionSelected.number * mdp->volume[state.orderItem] + state.usedCapacity > mdp->capacity) {
-					actionSelected.type = MDP::actionType::pass; // always define (1) action type and (2) decision of action
-					actionSelected.number = 0;
-					actionIndex = mdp->nrProducts + mdp->maxPallets;
-				}
-				else {
-					actionIndex = mdp->nrProducts + actionSelected.number - 1;
-				}
+			else if (state.cat.Index() == 1) { // quantity selection
+				return QuantityAction(*mdp, state, orderUpToLevel[state.orderItem]);
 			}
 
 			else {
 				throw DynaPlex::Error("joint_replenishment :: invalid aciton input in canOrderPolicy");
 			}
-
-			return actionIndex;
 		}
 
 		periodicReviewPolicy::periodicReviewPolicy(std::shared_ptr<const MDP> mdp, const DynaPlex::VarGroup& config)
@@ -109,87 +111,36 @@ namespace DynaPlex::Models {
 			config.Get("orderUpToLevel", orderUpToLevel);
 		}
 
-		int64_t periodicReviewPolicy::GetAction(const MDP::State& state) const {
-			MDP::actionClass actionSelected{};
-			int64_t actionIndex; // refers to placement of action on actionList
-			std::vector<int64_t> productsAllowed, inventoryPosition(mdp->nrProducts);
-			float totalOrderQuantity;
+		int64_t periodicReviewPolicy::GetAction(const MDP::State& state, DynaPlex::RNG& rng) const {
 
 			if (state.cat.Index() == 0) { // product selection
 
-				// check to see if we are in a review period
-				if (state.periodCount % reviewPeriod[0] == 0) {
-
-					// check which products have not already been ordered that need to be
-					for (int64_t product = 0; product < mdp->nrProducts; product++) {
-
-						// calculate inventory position
-						inventoryPosition[product] = state.SKUs[product].inventoryLevel;
-						for (int64_t i = 0; i < mdp->leadTime;i++) {
-							inventoryPosition[product] += state.SKUs[product].orderQty[i];
-						}
-
-						// add to possible order items if (1) not already ordered (2) inventory position is below reorder point (3) can fit into remaining container space
-						totalOrderQuantity = state.usedCapacity + (orderUpToLevel[product] - inventoryPosition[product]) * mdp->volume[product];
-
- 						if (state.SKUs[product].orderQty[mdp->leadTime - 1] == 0 && inventoryPosition[product] <= reorderPoint[product] && totalOrderQuantity <= mdp-> capacity) {
-							productsAllowed.push_back(product);
-						}
-					}
-
-					// if all products have been ordered already, move onto new period
-					if (productsAllowed.size() == 0) {
-						actionSelected.type = MDP::actionType::pass; // always define (1) action type and (2) decision of action
-						actionSelected.number = 0;
-						actionIndex = mdp->nrProducts + mdp->maxPallets;
-					}
-
-					// randomly select from permissible items
-					else {
-						actionSelected.type = MDP::actionType::productSelection;
-						int randomIndex = std::rand() % productsAllowed.size();
-						actionSelected.number = productsAllowed[randomIndex];
-						actionIndex = actionSelected.number;
-					}
-				}
-
 				// not in review period for inventory; move to next period
-				else {
-					actionSelected.type = MDP::actionType::pass;
-					actionSelected.number = 0;
-					actionIndex = mdp->nrProducts + mdp->maxPallets;
+				if (state.periodCount % reviewPeriod[0] != 0) {
+					return mdp->PassAction();
 				}
-			}
-
-			else if (state.cat.Index() == 1) { // quantity selection
 
-				// calculate inventory position
-				for (int64_t product = 0; product < mdp->nrProducts; product++) {
+				// add to possible order items if (1) not already ordered (2) inventory position is below reorder point (3) the order-up-to quantity is 1 to maxPallets and fits into remaining container space
+				auto isCandidate = [&](int64_t product) {
+					int64_t inventoryPosition = static_cast<int64_t>(state.InventoryPosition(product));
+					return state.OrderQty(product, mdp->leadTime - 1) == 0 && inventoryPosition <= reorderPoint[product] && CanOrderUpTo(*mdp, state, product, orderUpToLevel[product]);
+				};
+				int64_t product = DrawCandidate(mdp->nrProducts, isCandidate, rng);
 
-					inventoryPosition[product] = state.SKUs[product].inventoryLevel;
-					for (int64_t i = 0; i < mdp->leadTime;i++) {
-						inventoryPosition[product] += state.SKUs[product].orderQty[i];
-					}
+				// if all products have been ordered already, move onto new period
+				if (product < 0) {
+					return mdp->PassAction();
 				}
+				return ProductAction(*mdp, state, product, orderUpToLevel[product]);
+			}
 
-				actionSelected.type = MDP::actionType::quantitySelection;
-				actionSelected.number = orderUpToLevel[state.orderItem] - inventoryPosition[state.orderItem];
-
-				if (actionSelected.number * mdp->volume[state.orderItem] + state.usedCapacity > mdp->capacity) {
-					actionSelected.type = MDP::actionType::pass; // always define (1) action type and (2) decision of action
-					actionSelected.number = 0;
-					actionIndex = mdp->nrProducts + mdp->maxPallets;
-				}
-				else {
-					actionIndex = mdp->nrProducts + actionSelected.number - 1;
-				}
+			else if (state.cat.Index() == 1) { // quantity selection
+				return QuantityAction(*mdp, state, orderUpToLevel[state.orderItem]);
 			}
 
 			else {
 				throw DynaPlex::Error("joint_replenishment :: invalid action input in periodicReviewPolicy");
 			}
-
-			return actionIndex;
 		}
 	}
-}
\ No newline at end of file
+}
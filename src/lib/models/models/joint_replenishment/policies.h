@@ -20,7 +20,7 @@ namespace DynaPlex::Models {
 
 		public:
 			canOrderPolicy(std::shared_ptr<const MDP> mdp, const VarGroup& config);
-			int64_t GetAction(const MDP::State& state) const;
+			int64_t GetAction(const MDP::State& state, DynaPlex::RNG& rng) const;
 		};
 
 		class periodicReviewPolicy
@@ -34,7 +34,7 @@ namespace DynaPlex::Models {
 
 		public:
 			periodicReviewPolicy(std::shared_ptr<const MDP> mdp, const VarGroup& config);
-			int64_t GetAction(const MDP::State& state) const;
+			int64_t GetAction(const MDP::State& state, DynaPlex::RNG& rng) const;
 		};
 
 	}
@@ -20,6 +20,9 @@ namespace DynaPlex::NN
         double q_hat;
         std::vector<double> cost_improvement;
         std::vector<double> probabilities;
+        //flat features and mask of allowed actions (1 if allowed), as stored in binary sample files; empty unless loaded from such a file.
+        std::vector<float> features;
+        std::vector<uint8_t> allowed_actions_mask;
 
         Sample() = default;
         Sample(int64_t action_label, DynaPlex::dp_State state);
@@ -1,6 +1,9 @@
 #pragma once
+#include <cstdint>
+#include <iosfwd>
+#include <span>
 #include <vector>
-#include "dynaplex/sample.h" 
+#include "dynaplex/sample.h"
 #include "dynaplex/rng.h"
 #include "dynaplex/mdp.h"
 
@@ -9,12 +12,34 @@ namespace DynaPlex::NN
 	class SampleData
 	{
 		std::string unique_identifier;
+		static SampleData CreateNewFromBinaryFile(DynaPlex::MDP, std::string path);
+		static std::vector<DynaPlex::NN::Sample> ReadBinaryBlock(DynaPlex::MDP, std::istream& file, const std::string& path);
+		void ReadBinaryBlocks(DynaPlex::MDP, std::istream& file, const std::string& path);
+		void CheckBinaryWritable(DynaPlex::MDP) const;
+		void WriteBinaryBlock(DynaPlex::MDP, std::ostream& file) const;
 	public:
 		std::vector<DynaPlex::NN::Sample> Samples;
 		SampleData(DynaPlex::MDP);
 		void SaveToFile(DynaPlex::MDP, std::string path, int64_t json_indent=-1, bool silent=true);
+		/**
+		 * Saves the samples in a compact binary format, that is much faster to write and read than json for large
+		 * numbers of samples. The file starts with a header (magic, version, mdp identifier and dimensions), followed by
+		 * fixed-width columns (labels, sample numbers, q_hat, z_stat, features and masks of allowed actions), such that the
+		 * columns can be read or memory-mapped directly. Then follow variable-length columns (q_hat_vec, cost_improvement,
+		 * probabilities and states) that are stored as offsets followed by values. Features and masks are only stored if the
+		 * mdp provides flat features; on loading, they are restored into Sample::features and Sample::allowed_actions_mask.
+		 * If append is true, the samples are written as a new block at the end of the file. A binary sample file may consist of
+		 * several blocks, so binary files for the same mdp can be merged by concatenating them.
+		 */
+		void SaveToBinaryFile(DynaPlex::MDP, std::string path, bool silent = true, bool append = false);
+		/// Encodes the samples as a single block in the binary format of SaveToBinaryFile, e.g. to send them to another process.
+		std::vector<uint8_t> ToBinary(DynaPlex::MDP) const;
+		/// Adds samples encoded with ToBinary, or read from a binary sample file.
+		void AddFromBinary(DynaPlex::MDP, std::span<const uint8_t> bytes);
+		/// Loads samples saved with SaveToFile or SaveToBinaryFile; the format is detected from the file contents. Binary files
+		/// that are truncated, or whose dimensions do not match the mdp, result in a DynaPlex::Error.
 		static SampleData CreateNewFromFile(DynaPlex::MDP, std::string path);
 		void AddFromFile(DynaPlex::MDP, std::string path);
 		void PrintStatistics();
 	};
-}
\ No newline at end of file
+}
@@ -6,6 +6,7 @@
 #include "dynaplex/trainedpolicyprovider.h"
 #include "neuralnetworkprovider.h"
 #include <algorithm>
+#include <numeric>
 
 namespace DynaPlex::NN {
 
@@ -29,9 +30,10 @@ namespace DynaPlex::NN {
     }
 #if DP_TORCH_AVAILABLE
     std::tuple<torch::Tensor, torch::Tensor, torch::Tensor, torch::Tensor, torch::Tensor> prepare_batch(const std::span<DynaPlex::NN::Sample> samples, const DynaPlex::MDP& mdp) {
-        int batch_size = samples.size();
-        int input_dim = mdp->NumFlatFeatures();
-        int output_dim = mdp->NumValidActions();
+        // 64-bit sizes and offsets: the complete data set is prepared at once, and may exceed 2^31 features.
+        int64_t batch_size = static_cast<int64_t>(samples.size());
+        int64_t input_dim = mdp->NumFlatFeatures();
+        int64_t output_dim = mdp->NumValidActions();
 
         torch::Tensor batched_inputs = torch::empty({ batch_size, input_dim }, torch::kFloat32);
         torch::Tensor batched_targets = torch::empty({ batch_size }, torch::kInt64);
@@ -45,14 +47,25 @@ namespace DynaPlex::NN {
         float* cost_ptr = batched_relative_costs.data_ptr<float>();
         float* probs_ptr = batched_probs.data_ptr<float>();
 
-        for (int idx = 0; idx < batch_size; idx++) {
+        std::vector<int64_t> AllowedActions;
+        for (int64_t idx = 0; idx < batch_size; idx++) {
             const auto& sample = samples[idx];
 
             std::span<float> span(input_data_ptr + idx * input_dim, input_dim);
-            mdp->GetFlatFeatures(sample.state, span);
+            // Samples loaded from binary sample files carry their features and masks; other samples are computed from the state.
+            if (sample.features.size() == static_cast<size_t>(input_dim) && sample.allowed_actions_mask.size() == static_cast<size_t>(output_dim)) {
+                std::copy(sample.features.begin(), sample.features.end(), span.begin());
+                AllowedActions.clear();
+                for (int64_t action = 0; action < output_dim; action++)
+                    if (sample.allowed_actions_mask[action])
+                        AllowedActions.push_back(action);
+            }
+            else {
+                mdp->GetFlatFeatures(sample.state, span);
+                AllowedActions = mdp->AllowedActions(sample.state);
+            }
             target_data_ptr[idx] = sample.action_label;
 
-            std::vector<int64_t> AllowedActions = mdp->AllowedActions(sample.state);
             for (int64_t action : AllowedActions) {
                 mask_ptr[idx * output_dim + action] = 0.0f;
                 auto it = std::lower_bound(AllowedActions.begin(), AllowedActions.end(), action);
@@ -107,9 +120,24 @@ namespace DynaPlex::NN {
 
         DynaPlex::RNG rng{false, 26071983 };
         std::shuffle(data.Samples.begin(), data.Samples.end(), rng.gen());
-        std::span<DynaPlex::NN::Sample> training_data(data.Samples.begin(), data.Samples.begin() + training_size);
-        std::span<DynaPlex::NN::Sample> validation_data(data.Samples.begin() + training_size, data.Samples.end());
-        auto [validation_samples, validation_targets, validation_mask, validation_probs, validation_relative_costs] = prepare_batch(validation_data, mdp);
+        // Features, masks, targets, probabilities and costs are computed only once; epochs shuffle row indices into these tensors.
+        auto [all_inputs, all_targets, all_mask, all_probs, all_relative_costs] = prepare_batch(data.Samples, mdp);
+        int64_t num_validation = static_cast<int64_t>(data.Samples.size()) - training_size;
+        // The states are no longer needed.
+        data.Samples.clear();
+        data.Samples.shrink_to_fit();
+
+        torch::Tensor training_inputs = all_inputs.narrow(0, 0, training_size);
+        torch::Tensor training_targets = all_targets.narrow(0, 0, training_size);
+        torch::Tensor training_mask = all_mask.narrow(0, 0, training_size);
+        torch::Tensor training_probs = all_probs.narrow(0, 0, training_size);
+        torch::Tensor validation_samples = all_inputs.narrow(0, training_size, num_validation);
+        torch::Tensor validation_targets = all_targets.narrow(0, training_size, num_validation);
+        torch::Tensor validation_mask = all_mask.narrow(0, training_size, num_validation);
+        torch::Tensor validation_probs = all_probs.narrow(0, training_size, num_validation);
+        torch::Tensor validation_relative_costs = all_relative_costs.narrow(0, training_size, num_validation);
+        std::vector<int64_t> training_order(training_size);
+        std::iota(training_order.begin(), training_order.end(), int64_t{ 0 });
 
         int64_t num_batches = training_size / mini_batch_size;
         float best_validation_loss = std::numeric_limits<float>::max();
@@ -123,11 +151,17 @@ namespace DynaPlex::NN {
         auto start_time = std::chrono::steady_clock::now();
 
         do {
-            std::shuffle(training_data.begin(), training_data.end(), rng.gen());
+            std::shuffle(training_order.begin(), training_order.end(), rng.gen());
+            // Does not copy; training_order outlives the tensor.
+            torch::Tensor order = torch::from_blob(training_order.data(), { training_size }, torch::kInt64);
             float total_training_loss = 0.0;
             for (int64_t batch = 0; batch < num_batches; batch++) {
                 optimizer.zero_grad();       
-                auto [batched_inputs, batched_targets, mask, batched_probs, _] = prepare_batch({ &training_data[batch * mini_batch_size], static_cast<size_t>(mini_batch_size) }, mdp);
+                torch::Tensor rows = order.narrow(0, batch * mini_batch_size, mini_batch_size);
+                torch::Tensor batched_inputs = training_inputs.index_select(0, rows);
+                torch::Tensor batched_targets = training_targets.index_select(0, rows);
+                torch::Tensor mask = training_mask.index_select(0, rows);
+                torch::Tensor batched_probs = training_probs.index_select(0, rows);
 
                 // Forward pass.
                 torch::Tensor output = any_module.forward(batched_inputs) - mask;
@@ -177,7 +211,7 @@ namespace DynaPlex::NN {
                 }
 
                 torch::Tensor costs = torch::sum(torch::softmax(validation_output / 0.001, 1) * validation_relative_costs);
-                auto relative_cost_improvement = costs.item<float>() / validation_data.size();
+                auto relative_cost_improvement = costs.item<float>() / num_validation;
                 best_cost_improvement = std::min(best_cost_improvement, relative_cost_improvement);
 
                 // Check for improvement in validation loss
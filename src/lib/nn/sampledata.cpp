@@ -1,8 +1,213 @@
 #include "dynaplex/sampledata.h"
 #include "dynaplex/error.h"
 #include "dynaplex/rng.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <sstream>
 namespace DynaPlex::NN
 {
+	namespace {
+		//identifies binary sample files; the version is stored separately.
+		constexpr char binary_magic[8] = { 'D','P','S','A','M','P','L','E' };
+		constexpr uint32_t binary_version = 1;
+
+		template<typename T>
+		void Write(std::ostream& file, const T& value) {
+			file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+		}
+		template<typename T>
+		void WriteColumn(std::ostream& file, const std::vector<T>& column) {
+			file.write(reinterpret_cast<const char*>(column.data()), static_cast<std::streamsize>(column.size() * sizeof(T)));
+		}
+		template<typename T>
+		T Read(std::istream& file) {
+			T value;
+			file.read(reinterpret_cast<char*>(&value), sizeof(T));
+			return value;
+		}
+		template<typename T>
+		std::vector<T> ReadColumn(std::istream& file, uint64_t size) {
+			std::vector<T> column(size);
+			file.read(reinterpret_cast<char*>(column.data()), static_cast<std::streamsize>(size * sizeof(T)));
+			return column;
+		}
+
+		//variable-length column: offsets[i]..offsets[i+1] delimit the values of sample i.
+		template<typename T, typename t_Get>
+		void WriteRaggedColumn(std::ostream& file, const std::vector<Sample>& samples, const t_Get& get) {
+			std::vector<uint64_t> offsets{ 0 };
+			offsets.reserve(samples.size() + 1);
+			std::vector<T> values;
+			for (const auto& sample : samples)
+			{
+				const auto& sample_values = get(sample);
+				values.insert(values.end(), sample_values.begin(), sample_values.end());
+				offsets.push_back(values.size());
+			}
+			WriteColumn(file, offsets);
+			WriteColumn(file, values);
+		}
+		//number of bytes left in the stream, such that sizes read from a file can be checked before allocating.
+		uint64_t RemainingBytes(std::istream& file) {
+			auto position = file.tellg();
+			file.seekg(0, std::ios::end);
+			auto end = file.tellg();
+			file.seekg(position);
+			if (position < 0 || end < position)
+				return 0;
+			return static_cast<uint64_t>(end - position);
+		}
+		void CheckAvailable(std::istream& file, uint64_t count, uint64_t size_of, const std::string& path) {
+			if (!file || count > RemainingBytes(file) / size_of)
+				throw DynaPlex::Error("SampleData::CreateNewFromFile : binary sample file " + path + " is truncated or corrupt.");
+		}
+
+		template<typename T, typename t_Set>
+		void ReadRaggedColumn(std::istream& file, std::vector<Sample>& samples, const std::string& path, const t_Set& set) {
+			auto offsets = ReadColumn<uint64_t>(file, samples.size() + 1);
+			if (!file || offsets.front() != 0 || !std::is_sorted(offsets.begin(), offsets.end()))
+				throw DynaPlex::Error("SampleData::CreateNewFromFile : corrupt offsets in binary sample file " + path);
+			CheckAvailable(file, offsets.back(), sizeof(T), path);
+			auto values = ReadColumn<T>(file, offsets.back());
+			for (size_t i = 0; i < samples.size(); i++)
+				set(samples[i], std::span<const T>(values.data() + offsets[i], offsets[i + 1] - offsets[i]));
+		}
+
+		bool IsBinarySampleFile(const std::string& path) {
+			std::ifstream file(path, std::ios::binary);
+			char magic[sizeof(binary_magic)]{};
+			file.read(magic, sizeof(magic));
+			return file && std::memcmp(magic, binary_magic, sizeof(magic)) == 0;
+		}
+
+		//reads bytes in memory as a stream, without copying them.
+		class MemoryBuffer : public std::streambuf {
+		public:
+			explicit MemoryBuffer(std::span<const uint8_t> bytes) {
+				char* begin = const_cast<char*>(reinterpret_cast<const char*>(bytes.data()));
+				setg(begin, begin, begin + bytes.size());
+			}
+		protected:
+			//seeking is supported, such that the remaining size can be determined.
+			pos_type seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode) override {
+				char* base = dir == std::ios_base::beg ? eback() : dir == std::ios_base::cur ? gptr() : egptr();
+				if (offset < eback() - base || offset > egptr() - base)
+					return pos_type(off_type(-1));
+				setg(eback(), base + offset, egptr());
+				return pos_type(gptr() - eback());
+			}
+			pos_type seekpos(pos_type position, std::ios_base::openmode which) override {
+				return seekoff(off_type(position), std::ios_base::beg, which);
+			}
+		};
+
+		void CheckEndianness() {
+			if constexpr (std::endian::native != std::endian::little)
+				throw DynaPlex::Error("SampleData: binary sample files are only supported on little-endian platforms.");
+		}
+	}
+
+	void SampleData::CheckBinaryWritable(DynaPlex::MDP mdp) const
+	{
+		CheckEndianness();
+		if (!mdp->SupportsGetStateFromVarGroup())
+		{
+			throw DynaPlex::Error("This MDP does not support getting state from VarGroup. Currently, samples cannot be saved.");
+		}
+		for (auto& sample : Samples)
+		{
+			if (!mdp->CheckConformant(sample.state))
+			{
+				throw DynaPlex::Error("SampleData::SaveToBinaryFile : Error - trying to save samples that contain states not created with this mdp.");
+			}
+		}
+	}
+
+	void SampleData::SaveToBinaryFile(DynaPlex::MDP mdp, std::string path, bool silent, bool append)
+	{
+		CheckBinaryWritable(mdp);
+		if (!silent) {
+			PrintStatistics();
+		}
+
+		std::ofstream file(path, append ? std::ios::binary | std::ios::app : std::ios::binary);
+		if (!file.is_open())
+			throw DynaPlex::Error("SampleData::SaveToBinaryFile : failed to open file for writing: " + path);
+		WriteBinaryBlock(mdp, file);
+		if (!file)
+			throw DynaPlex::Error("SampleData::SaveToBinaryFile : failed to write to file: " + path);
+	}
+
+	std::vector<uint8_t> SampleData::ToBinary(DynaPlex::MDP mdp) const
+	{
+		CheckBinaryWritable(mdp);
+		std::ostringstream stream(std::ios::binary);
+		WriteBinaryBlock(mdp, stream);
+		std::string bytes = std::move(stream).str();
+		return std::vector<uint8_t>(bytes.begin(), bytes.end());
+	}
+
+	void SampleData::WriteBinaryBlock(DynaPlex::MDP mdp, std::ostream& file) const
+	{
+		//each call writes a self-contained block, such that blocks can be appended and files concatenated.
+		uint64_t num_samples = Samples.size();
+		int64_t num_features = mdp->ProvidesFlatFeatures() ? mdp->NumFlatFeatures() : 0;
+		int64_t num_valid_actions = mdp->NumValidActions();
+		std::string identifier = mdp->Identifier();
+
+		file.write(binary_magic, sizeof(binary_magic));
+		Write(file, binary_version);
+		Write(file, static_cast<uint64_t>(identifier.size()));
+		file.write(identifier.data(), static_cast<std::streamsize>(identifier.size()));
+		Write(file, num_samples);
+		Write(file, num_features);
+		Write(file, num_valid_actions);
+
+		//fixed-width columns:
+		std::vector<int64_t> int_column(num_samples);
+		std::vector<double> double_column(num_samples);
+		for (size_t i = 0; i < num_samples; i++)
+			int_column[i] = Samples[i].action_label;
+		WriteColumn(file, int_column);
+		for (size_t i = 0; i < num_samples; i++)
+			int_column[i] = Samples[i].sample_number;
+		WriteColumn(file, int_column);
+		for (size_t i = 0; i < num_samples; i++)
+			double_column[i] = Samples[i].q_hat;
+		WriteColumn(file, double_column);
+		for (size_t i = 0; i < num_samples; i++)
+			double_column[i] = Samples[i].z_stat;
+		WriteColumn(file, double_column);
+		if (num_features > 0)
+		{
+			std::vector<float> features(num_samples * num_features);
+			std::vector<uint8_t> mask(num_samples * num_valid_actions, 0);
+			for (size_t i = 0; i < num_samples; i++)
+			{
+				const auto& sample = Samples[i];
+				//samples loaded from a binary file already have them:
+				if (sample.features.size() == static_cast<size_t>(num_features) && sample.allowed_actions_mask.size() == static_cast<size_t>(num_valid_actions))
+				{
+					std::copy(sample.features.begin(), sample.features.end(), features.begin() + i * num_features);
+					std::copy(sample.allowed_actions_mask.begin(), sample.allowed_actions_mask.end(), mask.begin() + i * num_valid_actions);
+					continue;
+				}
+				mdp->GetFlatFeatures(sample.state, std::span<float>(features.data() + i * num_features, num_features));
+				for (int64_t action : mdp->AllowedActions(sample.state))
+					mask[i * num_valid_actions + action] = 1;
+			}
+			WriteColumn(file, features);
+			WriteColumn(file, mask);
+		}
+
+		//variable-length columns:
+		WriteRaggedColumn<double>(file, Samples, [](const Sample& sample) -> const auto& { return sample.q_hat_vec; });
+		WriteRaggedColumn<double>(file, Samples, [](const Sample& sample) -> const auto& { return sample.cost_improvement; });
+		WriteRaggedColumn<double>(file, Samples, [](const Sample& sample) -> const auto& { return sample.probabilities; });
+		WriteRaggedColumn<uint8_t>(file, Samples, [](const Sample& sample) { return sample.state->ToVarGroup().ToBinary(); });
+	}
 	void SampleData::SaveToFile(DynaPlex::MDP mdp, std::string path,int64_t json_indent, bool silent)
 	{
 		if (!mdp->SupportsGetStateFromVarGroup())
@@ -62,6 +267,8 @@ namespace DynaPlex::NN
 		{
 			throw DynaPlex::Error("This MDP does not support getting state from VarGroup. Currently, samples cannot be saved or loaded.");
 		}
+		if (IsBinarySampleFile(path))
+			return CreateNewFromBinaryFile(mdp, path);
 		auto vars = VarGroup::LoadFromFile(path);
 		std::string unique_identifier;
 		vars.Get("unique_identifier", unique_identifier);
@@ -99,6 +306,107 @@ namespace DynaPlex::NN
 	}
 
 
+	SampleData SampleData::CreateNewFromBinaryFile(DynaPlex::MDP mdp, std::string path)
+	{
+		CheckEndianness();
+		std::ifstream file(path, std::ios::binary);
+		if (!file.is_open())
+			throw DynaPlex::Error("SampleData::CreateNewFromFile : failed to open file for reading: " + path);
+		SampleData result{ mdp };
+		result.ReadBinaryBlocks(mdp, file, path);
+		return result;
+	}
+
+	void SampleData::AddFromBinary(DynaPlex::MDP mdp, std::span<const uint8_t> bytes)
+	{
+		if (mdp->Identifier() != unique_identifier)
+		{
+			throw DynaPlex::Error("SampleData::AddFromBinary - attempting to add data that results from a different (or differently parameterized) mdp:" + mdp->Identifier() + " vs " + unique_identifier);
+		}
+		CheckEndianness();
+		MemoryBuffer buffer{ bytes };
+		std::istream stream(&buffer);
+		ReadBinaryBlocks(mdp, stream, "in memory");
+	}
+
+	void SampleData::ReadBinaryBlocks(DynaPlex::MDP mdp, std::istream& file, const std::string& path)
+	{
+		//the data is a sequence of blocks, each written by a call to SaveToBinaryFile or ToBinary.
+		while (file.peek() != std::istream::traits_type::eof())
+		{
+			auto samples = ReadBinaryBlock(mdp, file, path);
+			Samples.insert(Samples.end(), std::make_move_iterator(samples.begin()), std::make_move_iterator(samples.end()));
+		}
+	}
+
+	std::vector<Sample> SampleData::ReadBinaryBlock(DynaPlex::MDP mdp, std::istream& file, const std::string& path)
+	{
+		char magic[sizeof(binary_magic)]{};
+		file.read(magic, sizeof(magic));
+		if (!file || std::memcmp(magic, binary_magic, sizeof(magic)) != 0)
+			throw DynaPlex::Error("SampleData::CreateNewFromFile : corrupt block in binary sample file " + path);
+		auto version = Read<uint32_t>(file);
+		if (version != binary_version)
+			throw DynaPlex::Error("SampleData::CreateNewFromFile : unsupported version " + std::to_string(version) + " of binary sample file " + path);
+		auto identifier_size = Read<uint64_t>(file);
+		CheckAvailable(file, identifier_size, 1, path);
+		std::string unique_identifier(identifier_size, '\0');
+		file.read(unique_identifier.data(), static_cast<std::streamsize>(unique_identifier.size()));
+		if (mdp->Identifier() != unique_identifier)
+		{
+			throw DynaPlex::Error("SampleData::CreateNewFromFile : Error - trying to load samples using a different (or differently parameterized) mdp compared to the mdp with which the states were created.");
+		}
+		auto num_samples = Read<uint64_t>(file);
+		auto num_features = Read<int64_t>(file);
+		auto num_valid_actions = Read<int64_t>(file);
+		if (!file)
+			throw DynaPlex::Error("SampleData::CreateNewFromFile : corrupt header in binary sample file " + path);
+		if (num_features != (mdp->ProvidesFlatFeatures() ? mdp->NumFlatFeatures() : 0) || num_valid_actions != mdp->NumValidActions())
+			throw DynaPlex::Error("SampleData::CreateNewFromFile : dimensions in binary sample file " + path + " do not match the mdp: "
+				+ std::to_string(num_features) + " features and " + std::to_string(num_valid_actions) + " valid actions.");
+		//fixed-width columns, and the offsets of the four variable-length columns:
+		uint64_t bytes_per_sample = 4 * sizeof(int64_t) + 4 * sizeof(uint64_t);
+		if (num_features > 0)
+			bytes_per_sample += num_features * sizeof(float) + num_valid_actions * sizeof(uint8_t);
+		CheckAvailable(file, num_samples, bytes_per_sample, path);
+
+		std::vector<Sample> samples(num_samples);
+		auto action_labels = ReadColumn<int64_t>(file, num_samples);
+		auto sample_numbers = ReadColumn<int64_t>(file, num_samples);
+		auto q_hats = ReadColumn<double>(file, num_samples);
+		auto z_stats = ReadColumn<double>(file, num_samples);
+		for (size_t i = 0; i < num_samples; i++)
+		{
+			samples[i].action_label = action_labels[i];
+			samples[i].sample_number = sample_numbers[i];
+			samples[i].q_hat = q_hats[i];
+			samples[i].z_stat = z_stats[i];
+		}
+		if (num_features > 0)
+		{
+			//loaded, such that consumers (e.g. PolicyTrainer) need not compute them from the states again.
+			for (auto& sample : samples)
+			{
+				sample.features.resize(num_features);
+				file.read(reinterpret_cast<char*>(sample.features.data()), static_cast<std::streamsize>(num_features * sizeof(float)));
+			}
+			for (auto& sample : samples)
+			{
+				sample.allowed_actions_mask.resize(num_valid_actions);
+				file.read(reinterpret_cast<char*>(sample.allowed_actions_mask.data()), static_cast<std::streamsize>(num_valid_actions));
+			}
+		}
+
+		auto to_vector = [](std::vector<double>& out, std::span<const double> values) { out.assign(values.begin(), values.end()); };
+		ReadRaggedColumn<double>(file, samples, path, [&](Sample& sample, std::span<const double> values) { to_vector(sample.q_hat_vec, values); });
+		ReadRaggedColumn<double>(file, samples, path, [&](Sample& sample, std::span<const double> values) { to_vector(sample.cost_improvement, values); });
+		ReadRaggedColumn<double>(file, samples, path, [&](Sample& sample, std::span<const double> values) { to_vector(sample.probabilities, values); });
+		ReadRaggedColumn<uint8_t>(file, samples, path, [&](Sample& sample, std::span<const uint8_t> bytes) { sample.state = mdp->GetState(VarGroup::FromBinary(bytes)); });
+		if (!file)
+			throw DynaPlex::Error("SampleData::CreateNewFromFile : binary sample file " + path + " is truncated.");
+		return samples;
+	}
+
 	void SampleData::AddFromFile(DynaPlex::MDP mdp, std::string path)
 	{
 		if (mdp->Identifier() != unique_identifier)
@@ -0,0 +1,52 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+#include "dynaplex/mdp.h"
+#include "dynaplex/policy.h"
+#include "dynaplex/system.h"
+#include "dynaplex/vargroup.h"
+#include "dynaplex/policycomparer.h"
+namespace DynaPlex::Utilities {
+	/**
+	 * Searches integer-valued policy parameters for the policy with the best expected return (lowest cost for minimization,
+	 * highest reward for maximization), using coordinate descent with a shrinking step. In each iteration, the incumbent and
+	 * all its neighbours are evaluated as one batch by a PolicyComparer, i.e. on common random numbers and in parallel over
+	 * trajectories. The best neighbour is then compared against the incumbent again on fresh trajectories, and replaces the
+	 * incumbent only if it is better by a statistically meaningful margin in that second comparison. Each evaluation uses
+	 * new trajectories, as does the final assessment of the returned policy.
+	 */
+	class ParameterSearch {
+	public:
+		/**
+		 * Config may include max_iterations (default: 100), initial_step (default: 4) and z_value (default: 2.0); a neighbour
+		 * only replaces the incumbent if its improvement in the confirming comparison exceeds z_value standard errors.
+		 * rng_seed (default: 13021984) seeds the first evaluation; later evaluations use subsequent seeds.
+		 * All other keys (number_of_trajectories, periods_per_trajectory, warmup_periods, ...) are passed on to the
+		 * PolicyComparers that evaluate candidates. Throws if the objective of the mdp is state-dependent.
+		 */
+		ParameterSearch(const DynaPlex::System& system, DynaPlex::MDP mdp, const DynaPlex::VarGroup& config = VarGroup{});
+
+		using Feasibility = std::function<bool(const DynaPlex::VarGroup&)>;
+
+		/**
+		 * Starts from initial_policy (a policy config including "id") and changes the entries of the integer vectors listed in
+		 * parameters. Candidates for which is_feasible returns false are not evaluated. Returns a VarGroup with the best
+		 * policy config found ("policy"), its estimated "mean" return and "error" on trajectories not used during the search,
+		 * and the number of "iterations" performed.
+		 */
+		DynaPlex::VarGroup Optimize(const DynaPlex::VarGroup& initial_policy, const std::vector<std::string>& parameters, Feasibility is_feasible = nullptr) const;
+
+	private:
+		/// comparer that uses rng_seed + seed_offset.
+		PolicyComparer GetComparer(int64_t seed_offset) const;
+		/// improvement of a result of a comparison relative to the benchmark, positive if better given the objective.
+		double Improvement(const DynaPlex::VarGroup& result, double& error) const;
+
+		int64_t max_iterations, initial_step, rng_seed;
+		double z_value, objective;
+		DynaPlex::System system;
+		DynaPlex::MDP mdp;
+		DynaPlex::VarGroup comparer_config;
+	};
+}//namespace DynaPlex::Utilities
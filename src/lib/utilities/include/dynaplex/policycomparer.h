@@ -6,13 +6,14 @@
 namespace DynaPlex::Utilities {
 	class PolicyComparer {
 
-		template<bool SkipTrivialActions=false>
 		void Evolve(const DynaPlex::Policy& policy, std::span<DynaPlex::Trajectory>, int64_t) const;
 
 		void CheckTrajectoriesInfiniteHorizon(std::span<DynaPlex::Trajectory>, int64_t) const;
 		void CheckTrajectoriesFiniteHorizon(std::span<DynaPlex::Trajectory>) const;
 
 		void ComputeReturns(std::span<double>& ReturnPerTrajectory, const DynaPlex::Policy& policy, int64_t offset) const;
+		/// collective: evaluates a range of the trajectories on each node, and gathers the returns on all nodes. Returns false if the returns cannot be gathered.
+		bool ComputeReturnsDistributed(const std::vector<DynaPlex::Policy>& policies, std::vector<std::vector<double>>& nestedReturnValues) const;
 
 	public:
 		/**
@@ -22,6 +23,7 @@ namespace DynaPlex::Utilities {
 		 * If mdp is finite horizon: config may include max_periods_until_error (default: 16384), this is the maximum number of steps in a trajectory until
 		 * mdp is expected to terminate by reaching final state. 
 		 * Config may also include rng_seed (default 13021984). 
+		 * On multiple MPI ranks, the trajectories are divided over the ranks, and all ranks obtain the same results as a single-node run. 
 		 */
 		PolicyComparer(const DynaPlex::System& system, DynaPlex::MDP mdp, const DynaPlex::VarGroup& config = VarGroup{});
 
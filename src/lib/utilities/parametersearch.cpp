@@ -0,0 +1,119 @@
+#include "dynaplex/parametersearch.h"
+#include "dynaplex/error.h"
+
+namespace DynaPlex::Utilities {
+
+	ParameterSearch::ParameterSearch(const DynaPlex::System& system, DynaPlex::MDP mdp, const VarGroup& config)
+		: system{ system }, mdp{ mdp }, comparer_config{ config }
+	{
+		if (!mdp)
+			throw DynaPlex::Error("ParameterSearch: parameter MDP should not be null");
+		//throws if the objective is state-dependent:
+		objective = mdp->Objective();
+		config.GetOrDefault("max_iterations", max_iterations, 100);
+		config.GetOrDefault("initial_step", initial_step, 4);
+		config.GetOrDefault("z_value", z_value, 2.0);
+		config.GetOrDefault("rng_seed", rng_seed, 13021984);
+		if (rng_seed < 0)
+			throw DynaPlex::Error("ParameterSearch :: Invalid rng_seed - should be non-negative");
+		if (initial_step < 1)
+			throw DynaPlex::Error("ParameterSearch :: initial_step should be at least 1");
+		if (max_iterations < 0)
+			throw DynaPlex::Error("ParameterSearch :: max_iterations should be non-negative");
+	}
+
+	PolicyComparer ParameterSearch::GetComparer(int64_t seed_offset) const
+	{
+		VarGroup config = comparer_config;
+		config.Set("rng_seed", rng_seed + seed_offset);
+		return PolicyComparer(system, mdp, config);
+	}
+
+	double ParameterSearch::Improvement(const VarGroup& result, double& error) const
+	{
+		double mean;
+		result.Get("mean", mean);
+		result.Get("error", error);
+		//mean is relative to the benchmark; objective is -1.0 for minimization.
+		return objective * mean;
+	}
+
+	VarGroup ParameterSearch::Optimize(const VarGroup& initial_policy, const std::vector<std::string>& parameters, Feasibility is_feasible) const
+	{
+		if (parameters.empty())
+			throw DynaPlex::Error("ParameterSearch :: no parameters to optimize");
+		if (is_feasible && !is_feasible(initial_policy))
+			throw DynaPlex::Error("ParameterSearch :: initial policy is not feasible");
+
+		VarGroup incumbent = initial_policy;
+		int64_t step = initial_step;
+		int64_t iteration = 0;
+		//every evaluation uses fresh trajectories, such that the search does not overfit a single set of trajectories.
+		int64_t seed_offset = 0;
+		while (iteration < max_iterations)
+		{
+			iteration++;
+			//the incumbent goes first, such that all neighbours are compared against it on common random numbers.
+			std::vector<VarGroup> candidates{ incumbent };
+			for (const auto& parameter : parameters)
+			{
+				VarGroup::Int64Vec values;
+				incumbent.Get(parameter, values);
+				for (size_t i = 0; i < values.size(); i++)
+				{
+					for (int64_t delta : { step, -step })
+					{
+						auto changed = values;
+						changed[i] += delta;
+						VarGroup candidate = incumbent;
+						candidate.Set(parameter, changed);
+						if (!is_feasible || is_feasible(candidate))
+							candidates.push_back(std::move(candidate));
+					}
+				}
+			}
+
+			std::vector<DynaPlex::Policy> policies;
+			policies.reserve(candidates.size());
+			for (const auto& candidate : candidates)
+				policies.push_back(mdp->GetPolicy(candidate));
+			auto results = GetComparer(seed_offset++).Compare(policies, 0);
+
+			size_t best = 0;
+			double best_improvement = 0.0;
+			for (size_t i = 1; i < results.size(); i++)
+			{
+				double error;
+				double improvement = Improvement(results[i], error);
+				if (improvement > best_improvement)
+				{
+					best = i;
+					best_improvement = improvement;
+				}
+			}
+
+			//the best of many noisy estimates is biased, so the selected neighbour is compared against the incumbent again,
+			//on trajectories not used for selecting it.
+			bool accepted = false;
+			if (best != 0)
+			{
+				auto confirmation = GetComparer(seed_offset++).Compare(policies[0], policies[best], 0);
+				double error;
+				double improvement = Improvement(confirmation[1], error);
+				accepted = improvement > z_value * error;
+			}
+			if (accepted)
+				incumbent = candidates[best];
+			else if (step > 1)
+				step /= 2;
+			else
+				break;
+		}
+
+		//reported on trajectories that were not used during the search, to avoid an optimistic estimate.
+		auto result = GetComparer(seed_offset).Assess(mdp->GetPolicy(incumbent));
+		result.Add("iterations", iteration);
+		return result;
+	}
+
+}  // namespace DynaPlex::Utilities
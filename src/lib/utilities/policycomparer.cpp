@@ -2,6 +2,7 @@
 #include "dynaplex/trajectory.h"
 #include "dynaplex/parallel_execute.h"
 #include "dynaplex/policycomparison.h"
+#include <cstring>
 namespace DynaPlex::Utilities {
 
 	void PolicyComparer::ComputeReturns(std::span<double>& ReturnPerTrajectory,const DynaPlex::Policy& policy, int64_t offset) const
@@ -118,36 +119,10 @@ namespace DynaPlex::Utilities {
 	}
 
 
-	template<bool SkipTrivialActions>
 	void PolicyComparer::Evolve(const DynaPlex::Policy& policy, std::span<DynaPlex::Trajectory> span, int64_t max_periods) const
 	{
-		while (true)
-		{
-			bool all_require_action;
-			if constexpr (SkipTrivialActions)
-			{
-				all_require_action = mdp->IncorporateUntilAction(span, max_periods);
-			}
-			else
-			{
-				all_require_action = mdp->IncorporateUntilNonTrivialAction(span, max_periods);
-			}
-			if (!all_require_action)
-			{
-				//This "sorts" the trajectories, such that the trajectories that are IsAwaitAction are at the front.
-				// Note that mdp->IncorporateAction only accepts set of adjacent trajectories that are all AwaitAction. 
-				std::span<DynaPlex::Trajectory>::iterator new_partition_point = std::partition(span.begin(), span.end(),
-					[](const DynaPlex::Trajectory& traj) {return traj.Category.IsAwaitAction(); }
-				);
-				//new_partition_point is the first element which does not require an action. 
-				//Make the span refer to a set of trajectories each awaiting an action:
-				span = std::span<DynaPlex::Trajectory>(span.begin(), new_partition_point);
-			}
-			//This means all trajectories are at period warmup_periods or final. 
-			if (span.size() == 0)
-				break;
-			mdp->IncorporateAction(span, policy);
-		}
+		//trivial actions are incorporated without consulting the policy.
+		mdp->Rollout(span, policy, max_periods, true);
 	}
 
 	DynaPlex::VarGroup PolicyComparer::Assess(DynaPlex::Policy policy) const {
@@ -165,6 +140,41 @@ namespace DynaPlex::Utilities {
 		return Compare(polVec, index_of_benchmark);
 	}
 
+	bool PolicyComparer::ComputeReturnsDistributed(const std::vector<DynaPlex::Policy>& policies, std::vector<std::vector<double>>& nestedReturnValues) const
+	{
+		auto splits = DynaPlex::Parallel::get_splits(number_of_trajectories, system.WorldSize());
+		auto [node_start, node_end] = splits[system.WorldRank()];
+		int64_t on_node = node_end - node_start;
+
+		//returns of this node, for all policies consecutively:
+		std::vector<uint8_t> bytes(policies.size() * on_node * sizeof(double));
+		for (size_t i = 0; i < policies.size(); i++)
+		{
+			auto& policy = policies[i];
+			std::vector<double> returns(on_node, 0.0);
+			DynaPlex::Parallel::parallel_compute<double>(system, returns, [this, &policy, node_start](std::span<double> span, int64_t start) {
+				this->ComputeReturns(span, policy, node_start + start);
+				});
+			std::memcpy(bytes.data() + i * on_node * sizeof(double), returns.data(), on_node * sizeof(double));
+		}
+
+		//all nodes receive all returns, such that all nodes report identical results.
+		std::vector<std::vector<uint8_t>> gathered;
+		if (!system.AllGather(bytes, gathered))
+			return false;
+		for (size_t i = 0; i < policies.size(); i++)
+		{
+			std::vector<double> returns(number_of_trajectories);
+			for (size_t rank = 0; rank < splits.size(); rank++)
+			{
+				auto [start, end] = splits[rank];
+				std::memcpy(returns.data() + start, gathered[rank].data() + i * (end - start) * sizeof(double), (end - start) * sizeof(double));
+			}
+			nestedReturnValues.push_back(std::move(returns));
+		}
+		return true;
+	}
+
 	std::vector<VarGroup> PolicyComparer::Compare(std::vector<DynaPlex::Policy> policies, int64_t index_of_benchmark) const {
 		std::vector<std::vector<double>> nestedReturnValues{};
 		nestedReturnValues.reserve(policies.size());
@@ -174,18 +184,26 @@ namespace DynaPlex::Utilities {
 			throw DynaPlex::Error("PolicyComparer: invalid value for index_of_benchmark; should be -1 or an index corresponding to a policy. Actual value: " + std::to_string(index_of_benchmark));
 		}
 		
-		for (int i=0;i<policies.size();i++)
+		for (auto& policy : policies)
 		{
-			auto& policy = policies[i];
 			if (!policy) {
 				throw DynaPlex::Error("PolicyComparer: policy should not be null");
 			}
-			nestedReturnValues.push_back(std::vector<double>(number_of_trajectories, 0.0));
-		
+		}
 
-			DynaPlex::Parallel::parallel_compute<double>(nestedReturnValues[i], [this, &policy](std::span<double> span, int64_t start) {
-				this->ComputeReturns(span, policy, start);
-				}, system.HardwareThreads());			
+		//on multiple nodes, each node evaluates a range of the trajectories; trajectories are seeded by their global index.
+		bool distributed = system.WorldSize() > 1 && system.SupportsGather() && number_of_trajectories >= static_cast<int64_t>(system.WorldSize());
+		if (distributed)
+			distributed = ComputeReturnsDistributed(policies, nestedReturnValues);
+		if (!distributed)
+		{
+			for (auto& policy : policies)
+			{
+				nestedReturnValues.push_back(std::vector<double>(number_of_trajectories, 0.0));
+				DynaPlex::Parallel::parallel_compute<double>(system, nestedReturnValues.back(), [this, &policy](std::span<double> span, int64_t start) {
+					this->ComputeReturns(span, policy, start);
+					});
+			}
 		}
 
 		DynaPlex::PolicyComparison comparison{ nestedReturnValues };
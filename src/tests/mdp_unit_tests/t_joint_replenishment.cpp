@@ -0,0 +1,403 @@
+﻿#include "dynaplex/vargroup.h"
+#include "dynaplex/error.h"
+#include <gtest/gtest.h>
+#include "dynaplex/dynaplexprovider.h"
+#include "dynaplex/trajectory.h"
+#include "dynaplex/retrievestate.h"
+#include "dynaplex/models/joint_replenishment/mdp.h"
+#include "testutils.h" // for ExecuteTest
+namespace DynaPlex::Tests {
+
+	TEST(joint_replenishment, mdp_config_0) {
+		std::string model_name = "joint_replenishment";
+		//Note: models/model_name/mdp_config_name is valid json config file for mdp "model_name". 
+		std::string mdp_config_name = "mdp_config_0.json";
+		Tester tester{};
+		tester.AssertFlatFeatureAvailability = true;
+		tester.TestEventProbs = true;
+
+		tester.ExecuteTest(model_name, mdp_config_name);
+	}
+
+	TEST(joint_replenishment, policy_config_0) {
+		std::string model_name = "joint_replenishment";
+		std::string mdp_config_name = "mdp_config_0.json";
+		//can-order policy; draws from the policy RNG of the trajectory.
+		std::string policy_config_name = "policy_config_0.json";
+		Tester tester{};
+
+		tester.ExecuteTest(model_name, mdp_config_name, policy_config_name);
+	}
+
+	TEST(joint_replenishment, policy_config_1) {
+		std::string model_name = "joint_replenishment";
+		std::string mdp_config_name = "mdp_config_0.json";
+		//periodic review policy
+		std::string policy_config_name = "policy_config_1.json";
+		Tester tester{};
+
+		tester.ExecuteTest(model_name, mdp_config_name, policy_config_name);
+	}
+
+	TEST(joint_replenishment, single_stage_policy) {
+		std::string model_name = "joint_replenishment";
+		std::string mdp_config_name = "mdp_config_1.json";
+		std::string policy_config_name = "policy_config_0.json";
+		Tester tester{};
+
+		tester.ExecuteTest(model_name, mdp_config_name, policy_config_name);
+	}
+
+	TEST(joint_replenishment, mdp_config_1) {
+		std::string model_name = "joint_replenishment";
+		//single-stage action mode
+		std::string mdp_config_name = "mdp_config_1.json";
+		Tester tester{};
+		tester.AssertFlatFeatureAvailability = true;
+
+		tester.ExecuteTest(model_name, mdp_config_name);
+	}
+
+	TEST(joint_replenishment, mdp_config_2) {
+		std::string model_name = "joint_replenishment";
+		//non-stationary demand
+		std::string mdp_config_name = "mdp_config_2.json";
+		Tester tester{};
+		tester.AssertFlatFeatureAvailability = true;
+		tester.TestEventProbs = true;
+
+		tester.ExecuteTest(model_name, mdp_config_name);
+	}
+
+	TEST(joint_replenishment, DemandSchedule) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+		std::string file_path = system.filepath("mdp_config_examples", "joint_replenishment", "mdp_config_2.json");
+		auto vars = VarGroup::LoadFromFile(file_path);
+		Models::joint_replenishment::MDP mdp(vars);
+		ASSERT_TRUE(mdp.isNonStationary);
+
+		//the demand distribution follows the schedule entry of the current period.
+		auto state = mdp.GetInitialState();
+		ASSERT_EQ(state.remainingEvents, mdp.horizon);
+		for (int64_t period = 0; period < mdp.horizon; period++)
+		{
+			state.periodCount = period + 1;
+			for (int64_t product = 0; product < mdp.nrProducts; product++)
+			{
+				auto& dist = mdp.DemandDist(state, product);
+				EXPECT_NEAR(1.0 - dist.ProbabilityAt(0), mdp.orderRateSchedule[product][period], 1e-10);
+			}
+		}
+		state.periodCount = mdp.horizon + 1;
+		EXPECT_THROW(mdp.DemandDist(state, 0), DynaPlex::Error);
+
+		//the horizon ends after the last scheduled period.
+		DynaPlex::RNG rng(true, 1234);
+		state = mdp.GetInitialState();
+		Models::joint_replenishment::MDP::Event event;
+		for (int64_t period = 0; period < mdp.horizon; period++)
+		{
+			ASSERT_TRUE(state.cat.IsAwaitAction());
+			mdp.ModifyStateWithAction(state, mdp.PassAction());
+			mdp.GetEvent(state, rng, event);
+			mdp.ModifyStateWithEvent(state, event);
+		}
+		EXPECT_TRUE(state.cat.IsFinal());
+	}
+
+	TEST(joint_replenishment, SingleStageOrder) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+		std::string file_path = system.filepath("mdp_config_examples", "joint_replenishment", "mdp_config_1.json");
+		auto vars = VarGroup::LoadFromFile(file_path);
+		Models::joint_replenishment::MDP mdp(vars);
+		ASSERT_TRUE(mdp.singleStageActions);
+		ASSERT_EQ(mdp.actions.size(), mdp.nrProducts * mdp.maxPallets + 1);
+
+		auto state = mdp.GetInitialState();
+		int64_t orderSize = 3;
+		int64_t action = mdp.OrderAction(1, orderSize);
+		ASSERT_TRUE(mdp.IsAllowedAction(state, action));
+		mdp.ModifyStateWithAction(state, action);
+		//the order is placed in a single decision, after which the next order can be selected.
+		EXPECT_EQ(state.OrderQty(1, mdp.leadTime - 1), orderSize);
+		EXPECT_EQ(state.inTransit[1], orderSize);
+		EXPECT_TRUE(state.cat.IsAwaitAction());
+		EXPECT_EQ(state.cat.Index(), 0);
+		EXPECT_FALSE(mdp.IsAllowedAction(state, mdp.OrderAction(1, 1)));
+		EXPECT_TRUE(mdp.IsAllowedAction(state, mdp.PassAction()));
+		mdp.ModifyStateWithAction(state, mdp.PassAction());
+		EXPECT_TRUE(state.cat.IsAwaitEvent());
+	}
+
+	TEST(joint_replenishment, SingleStagePolicyOrderQuantities) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+		std::string file_path = system.filepath("mdp_config_examples", "joint_replenishment", "mdp_config_1.json");
+		auto vars = VarGroup::LoadFromFile(file_path);
+		//a container that fits more than maxPallets of each product:
+		vars.Set("capacity", 1000.0);
+		auto mdp = dp.GetMDP(vars);
+
+		//reorder points at or above the order-up-to levels, and order-up-to levels beyond maxPallets; products that
+		//cannot be ordered up to their level in a single order of 1 to maxPallets pallets are skipped, not ordered.
+		std::vector<VarGroup> policy_configs{
+			VarGroup{ {"id", "periodicReviewPolicy"}, {"reviewPeriod", std::vector<int64_t>{ 1 }},
+				{"reorderPoint", std::vector<int64_t>{ 30, 30, 30, 30 }}, {"orderUpToLevel", std::vector<int64_t>{ 20, 20, 20, 20 }} },
+			VarGroup{ {"id", "periodicReviewPolicy"}, {"reviewPeriod", std::vector<int64_t>{ 1 }},
+				{"reorderPoint", std::vector<int64_t>{ 100, 100, 100, 100 }}, {"orderUpToLevel", std::vector<int64_t>{ 200, 200, 200, 200 }} },
+			VarGroup{ {"id", "canOrderPolicy"}, {"reorderPoint", std::vector<int64_t>{ 100, 100, 100, 100 }},
+				{"canOrderPoint", std::vector<int64_t>{ 150, 150, 150, 150 }}, {"orderUpToLevel", std::vector<int64_t>{ 200, 200, 200, 200 }} }
+		};
+		for (auto& policy_config : policy_configs)
+		{
+			auto policy = mdp->GetPolicy(policy_config);
+			std::vector<Trajectory> trajectories(4);
+			for (int64_t i = 0; i < 4; i++)
+				trajectories[i].RNGProvider.SeedEventStreams(true, 1234, i);
+			mdp->InitiateState(trajectories);
+			EXPECT_NO_THROW(mdp->Rollout(trajectories, policy, 100));
+		}
+	}
+
+	TEST(joint_replenishment, GetAllowedActions) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+		for (std::string mdp_config_name : { "mdp_config_0.json", "mdp_config_1.json" }) {
+			std::string file_path = system.filepath("mdp_config_examples", "joint_replenishment", mdp_config_name);
+			Models::joint_replenishment::MDP mdp(VarGroup::LoadFromFile(file_path));
+			int64_t numActions = static_cast<int64_t>(mdp.actions.size());
+
+			DynaPlex::RNG rng(true, 2209);
+			auto state = mdp.GetInitialState();
+			DynaPlex::ActionMask mask;
+			int64_t trivialCount = 0;
+			for (int64_t step = 0; step < 500; step++) {
+				if (state.cat.IsAwaitAction()) {
+					mask.Reset(numActions);
+					mdp.GetAllowedActions(state, mask);
+					for (int64_t action = 0; action < numActions; action++) {
+						ASSERT_EQ(mask.IsAllowed(action), mdp.IsAllowedAction(state, action)) << mdp_config_name << " action " << action;
+					}
+					//TrivialAction identifies exactly the states with a single allowed action.
+					auto trivialAction = mdp.TrivialAction(state);
+					if (mask.Count() == 1) {
+						ASSERT_EQ(trivialAction, mask.Next(0)) << mdp_config_name;
+						trivialCount++;
+					}
+					else {
+						ASSERT_FALSE(trivialAction.has_value()) << mdp_config_name;
+					}
+					//pick a random allowed action, such that orders of various sizes are placed.
+					int64_t budget = static_cast<int64_t>(rng.genUniform() * mask.Count());
+					int64_t action = mask.Next(0);
+					while (budget-- > 0) {
+						action = mask.Next(action + 1);
+					}
+					mdp.ModifyStateWithAction(state, action);
+				}
+				else {
+					mdp.ModifyStateWithEvent(state, mdp.GetEvent(state, rng));
+				}
+			}
+			EXPECT_GT(trivialCount, 0) << mdp_config_name;
+		}
+	}
+
+	TEST(joint_replenishment, PipelineArrival) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+		std::string file_path = system.filepath("mdp_config_examples", "joint_replenishment", "mdp_config_0.json");
+		auto vars = VarGroup::LoadFromFile(file_path);
+		DynaPlex::MDP mdp;
+		ASSERT_NO_THROW(
+			mdp = dp.GetMDP(vars);
+		);
+		int64_t nrProducts, maxPallets, leadTime;
+		vars.Get("nrProducts", nrProducts);
+		vars.Get("maxPallets", maxPallets);
+		vars.Get("leadTime", leadTime);
+		int64_t pass = nrProducts + maxPallets;
+		int64_t orderSize = 3;
+
+		//two trajectories with common random numbers; the first orders for product 0 in the first period. 
+		std::vector<Trajectory> trajectories(2);
+		for (auto& traj : trajectories)
+		{
+			traj.RNGProvider.SeedEventStreams(true, 1234);
+		}
+		mdp->InitiateState(trajectories);
+		std::vector<int64_t> first_actions = { 0, nrProducts + orderSize - 1, pass };
+		for (int64_t action : first_actions)
+		{
+			trajectories[0].NextAction = action;
+			ASSERT_NO_THROW(
+				mdp->IncorporateAction({ &trajectories[0],1 });
+			);
+		}
+		trajectories[1].NextAction = pass;
+		mdp->IncorporateAction({ &trajectories[1],1 });
+
+		using underlying_mdp = DynaPlex::Models::joint_replenishment::MDP;
+		for (int64_t period = 1; period <= leadTime; period++)
+		{
+			mdp->IncorporateEvent(trajectories);
+			auto& ordered = DynaPlex::RetrieveState<underlying_mdp::State>(trajectories[0].GetState());
+			auto& not_ordered = DynaPlex::RetrieveState<underlying_mdp::State>(trajectories[1].GetState());
+			double difference = ordered.inventoryLevel[0] - not_ordered.inventoryLevel[0];
+			if (period < leadTime)
+			{
+				EXPECT_EQ(difference, 0.0);
+				EXPECT_EQ(ordered.OrderQty(0, leadTime - 1 - period), orderSize);
+			}
+			else
+			{
+				EXPECT_EQ(difference, static_cast<double>(orderSize));
+			}
+			//the running in-transit total must agree with the pipeline contents. 
+			int64_t pipeline_total = 0;
+			for (int64_t k = 0; k < leadTime; k++)
+			{
+				pipeline_total += ordered.OrderQty(0, k);
+			}
+			EXPECT_EQ(ordered.inTransit[0], pipeline_total);
+			EXPECT_EQ(ordered.InventoryPosition(0) - not_ordered.InventoryPosition(0), static_cast<double>(orderSize));
+			for (auto& traj : trajectories)
+			{
+				ASSERT_TRUE(traj.Category.IsAwaitAction());
+				traj.NextAction = pass;
+			}
+			mdp->IncorporateAction(trajectories);
+		}
+	}
+
+	TEST(joint_replenishment, GetEventInPlace) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+		std::string file_path = system.filepath("mdp_config_examples", "joint_replenishment", "mdp_config_0.json");
+		auto vars = VarGroup::LoadFromFile(file_path);
+		Models::joint_replenishment::MDP mdp(vars);
+
+		DynaPlex::RNG rng_returned(true, 4321);
+		DynaPlex::RNG rng_in_place(true, 4321);
+		Models::joint_replenishment::MDP::Event buffer;
+		auto state = mdp.GetInitialState();
+		for (int64_t i = 0; i < 100; i++)
+		{
+			auto returned = mdp.GetEvent(state, rng_returned);
+			mdp.GetEvent(state, rng_in_place, buffer);
+			ASSERT_EQ(returned, buffer);
+		}
+	}
+
+	TEST(joint_replenishment, EventProbabilities) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+		std::string file_path = system.filepath("mdp_config_examples", "joint_replenishment", "mdp_config_0.json");
+		auto vars = VarGroup::LoadFromFile(file_path);
+		vars.Add("eventProbabilityThreshold", 0.0);
+		Models::joint_replenishment::MDP mdp(vars);
+
+		//without pruning, the enumeration is exact: probabilities sum to one and marginal means match.
+		auto state = mdp.GetInitialState();
+		auto eventProbs = mdp.EventProbabilities(state);
+		std::vector<double> mean(mdp.nrProducts, 0.0);
+		double total = 0.0;
+		for (const auto& [event, prob] : eventProbs)
+		{
+			total += prob;
+			for (int64_t product = 0; product < mdp.nrProducts; product++)
+				mean[product] += event[product] * prob;
+		}
+		ASSERT_NEAR(total, 1.0, 1e-10);
+		for (int64_t product = 0; product < mdp.nrProducts; product++)
+		{
+			double expected = 0.0;
+			for (size_t k = 0; k < mdp.demandProb[product].size(); k++)
+				expected += mdp.orderRate[product] * mdp.demandProb[product][k] * (k + 1);
+			ASSERT_NEAR(mean[product], expected, 1e-10);
+		}
+
+		//pruning keeps fewer outcomes, renormalized to a distribution.
+		vars.Set("eventProbabilityThreshold", 1e-4);
+		Models::joint_replenishment::MDP pruned_mdp(vars);
+		auto prunedProbs = pruned_mdp.EventProbabilities(state);
+		ASSERT_LT(prunedProbs.size(), eventProbs.size());
+		total = 0.0;
+		for (const auto& [event, prob] : prunedProbs)
+			total += prob;
+		ASSERT_NEAR(total, 1.0, 1e-10);
+	}
+
+	TEST(joint_replenishment, KPIs) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+		std::string file_path = system.filepath("mdp_config_examples", "joint_replenishment", "mdp_config_0.json");
+		auto vars = VarGroup::LoadFromFile(file_path);
+		vars.Add("trackKPIs", true);
+		Models::joint_replenishment::MDP mdp(vars);
+
+		//order 3 pallets of product 0 in every period, and accumulate the costs that ModifyStateWithEvent returns.
+		DynaPlex::RNG rng(true, 1234);
+		auto state = mdp.GetInitialState();
+		Models::joint_replenishment::MDP::Event event;
+		double totalCost = 0.0;
+		int64_t periods = 50;
+		for (int64_t period = 0; period < periods; period++)
+		{
+			mdp.ModifyStateWithAction(state, 0);
+			mdp.ModifyStateWithAction(state, mdp.nrProducts + 2);
+			mdp.ModifyStateWithAction(state, mdp.PassAction());
+			mdp.GetEvent(state, rng, event);
+			totalCost += mdp.ModifyStateWithEvent(state, event);
+		}
+		auto& kpis = state.kpis;
+		EXPECT_EQ(kpis.periods, periods);
+		EXPECT_EQ(kpis.containers, periods);
+		EXPECT_EQ(kpis.orderCount[0], periods);
+		EXPECT_EQ(kpis.orderedQty[0], 3 * periods);
+		EXPECT_EQ(kpis.orderCount[1], 0);
+		EXPECT_NEAR(kpis.usedCapacity, 3 * mdp.volume[0] * periods, 1e-9);
+		EXPECT_NEAR(kpis.holdingCosts + kpis.backorderCosts + kpis.orderingCosts, totalCost, 1e-6);
+		for (int64_t product = 0; product < mdp.nrProducts; product++)
+		{
+			EXPECT_NEAR(kpis.demandMet[product] + kpis.backorders[product], kpis.demand[product], 1e-9);
+		}
+
+		//KPIs are part of the state, and survive serialization.
+		auto copy = mdp.GetState(state.ToVarGroup());
+		EXPECT_EQ(copy, state);
+
+		Models::joint_replenishment::MDP::KPIs total{};
+		total.Add(kpis);
+		total.Add(kpis);
+		EXPECT_EQ(total.periods, 2 * periods);
+		EXPECT_EQ(total.orderedQty[0], 6 * periods);
+	}
+
+	TEST(joint_replenishment, GetStateFromLegacyVarGroup) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+		std::string file_path = system.filepath("mdp_config_examples", "joint_replenishment", "mdp_config_0.json");
+		Models::joint_replenishment::MDP mdp(VarGroup::LoadFromFile(file_path));
+		auto state = mdp.GetInitialState();
+		auto vars = state.ToVarGroup();
+
+		//states saved before the period costs and count were stored only have these keys:
+		std::vector<VarGroup> SKUs;
+		vars.Get("SKUs", SKUs);
+		VarGroup legacy{};
+		legacy.Add("cat", state.cat);
+		legacy.Add("usedCapacity", state.usedCapacity);
+		legacy.Add("SKUs", SKUs);
+		legacy.Add("remainingEvents", state.remainingEvents);
+		legacy.Add("orderItem", state.orderItem);
+
+		Models::joint_replenishment::MDP::State restored;
+		ASSERT_NO_THROW(restored = mdp.GetState(legacy));
+		EXPECT_EQ(restored.periodCount, 1);
+		EXPECT_EQ(restored.periodOrderingCosts, 0.0);
+		EXPECT_EQ(restored.inventoryLevel, state.inventoryLevel);
+	}
+}
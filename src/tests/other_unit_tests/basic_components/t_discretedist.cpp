@@ -250,6 +250,82 @@ namespace DynaPlex::Tests {
 
 
 
+	TEST(discretedist, GetSampleFromUniform) {
+		auto dist = DiscreteDist::GetCustomDist({ 0.1, 0.2, 0.4, 0.1, 0.1, 0.0, 0.0, 0.0, 0.1 }, 2);
+		auto optimized = dist;
+		optimized.OptimizeForSampling();
+		for (const auto& d : { dist, optimized })
+		{
+			EXPECT_EQ(d.GetSampleFromUniform(0.0), 2);
+			EXPECT_EQ(d.GetSampleFromUniform(0.05), 2);
+			//the first value whose cumulative probability exceeds the uniform, also at the boundary:
+			EXPECT_EQ(d.GetSampleFromUniform(0.1), 3);
+			EXPECT_EQ(d.GetSampleFromUniform(0.5), 4);
+			EXPECT_EQ(d.GetSampleFromUniform(0.95), 10);
+
+			//uniforms drawn at once give the same samples as drawing them one by one.
+			DynaPlex::RNG rng{ false, 1234 }, rng2{ false, 1234 };
+			std::vector<double> uniforms(100);
+			rng.genUniforms(uniforms);
+			for (double uniform : uniforms)
+				ASSERT_EQ(d.GetSampleFromUniform(uniform), d.GetSample(rng2));
+		}
+	}
+
+	TEST(discretedist, GetSamples) {
+		std::vector<double> probs = { 0.1, 0.2, 0.4, 0.0, 0.1, 0.0, 0.0, 0.0, 0.2 };
+		auto dist = DiscreteDist::GetCustomDist(probs, -3);
+		{//without alias table, samples equal those of GetSample.
+			DynaPlex::RNG rng{ false, 4321 }, rng2{ false, 4321 };
+			std::vector<int64_t> samples(50);
+			dist.GetSamples(rng, samples);
+			for (int64_t sample : samples)
+				ASSERT_EQ(sample, dist.GetSample(rng2));
+		}
+		dist.OptimizeForSampling();
+		DynaPlex::RNG rng{ false, 4321 }, rng2{ false, 4321 };
+		std::vector<int64_t> samples(200000), samples2(samples.size());
+		dist.GetSamples(rng, samples);
+		dist.GetSamples(rng2, samples2);
+		ASSERT_EQ(samples, samples2);
+
+		std::vector<double> frequencies(probs.size(), 0.0);
+		for (int64_t sample : samples)
+		{
+			ASSERT_GE(sample, dist.Min());
+			ASSERT_LE(sample, dist.Max());
+			frequencies[sample - dist.Min()] += 1.0 / samples.size();
+		}
+		for (size_t i = 0; i < probs.size(); i++)
+		{
+			if (probs[i] == 0.0)
+				EXPECT_EQ(frequencies[i], 0.0);
+			else
+				EXPECT_NEAR(frequencies[i], probs[i], 0.005);
+		}
+	}
+
+	TEST(discretedist, AddAndTakeMaximum) {
+		auto first = DiscreteDist::GetCustomDist({ 0.5, 0.0, 0.5 }, 1);
+		auto second = DiscreteDist::GetCustomDist({ 0.25, 0.75 }, -1);
+		auto sum = first.Add(second);
+		EXPECT_EQ(sum.Min(), 0);
+		EXPECT_EQ(sum.Max(), 3);
+		EXPECT_DOUBLE_EQ(sum.ProbabilityAt(0), 0.125);
+		EXPECT_DOUBLE_EQ(sum.ProbabilityAt(1), 0.375);
+		EXPECT_DOUBLE_EQ(sum.ProbabilityAt(2), 0.125);
+		EXPECT_DOUBLE_EQ(sum.ProbabilityAt(3), 0.375);
+
+		auto maximum = sum.TakeMaximumWith(1);
+		EXPECT_EQ(maximum.Min(), 1);
+		EXPECT_DOUBLE_EQ(maximum.ProbabilityAt(1), 0.5);
+		EXPECT_DOUBLE_EQ(maximum.ProbabilityAt(2), 0.125);
+		EXPECT_DOUBLE_EQ(maximum.ProbabilityAt(3), 0.375);
+		EXPECT_EQ(maximum.Fractile(0.4), 1);
+		EXPECT_EQ(maximum.Fractile(0.6), 2);
+		EXPECT_EQ(maximum.Fractile(0.7), 3);
+	}
+
 	TEST(discretedist, fractile) {
 		// Let's consider a simple discrete distribution for the test
 		std::vector<double> probs = { 0.1, 0.2, 0.4, 0.2, 0.1 };  // A bell-shaped probability mass function
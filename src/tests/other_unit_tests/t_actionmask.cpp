@@ -0,0 +1,45 @@
+﻿#include "dynaplex/vargroup.h"
+#include "dynaplex/error.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "dynaplex/actionmask.h"
+
+
+namespace DynaPlex::Tests {
+
+	TEST(ActionMask, Basics) {
+		//sizes within and beyond the inline storage, and not a multiple of 64
+		for (int64_t size : { 0, 1, 85, 256, 300 })
+		{
+			DynaPlex::ActionMask mask(size);
+			EXPECT_EQ(mask.Size(), size);
+			EXPECT_EQ(mask.Count(), 0);
+			EXPECT_EQ(mask.Next(0), size);
+
+			std::vector<int64_t> allowed;
+			for (int64_t action = 0; action < size; action += 7)
+			{
+				mask.Allow(action);
+				allowed.push_back(action);
+			}
+			if (size > 0)
+			{
+				mask.Allow(size - 1);
+				if (allowed.back() != size - 1)
+					allowed.push_back(size - 1);
+			}
+			EXPECT_EQ(mask.Count(), static_cast<int64_t>(allowed.size()));
+
+			std::vector<int64_t> found;
+			for (int64_t action = mask.Next(0); action < size; action = mask.Next(action + 1))
+				found.push_back(action);
+			EXPECT_EQ(found, allowed);
+			for (int64_t action = 0; action < size; action++)
+				EXPECT_EQ(mask.IsAllowed(action), std::find(allowed.begin(), allowed.end(), action) != allowed.end());
+
+			EXPECT_THROW(mask.Allow(size), DynaPlex::Error);
+			mask.Reset(size);
+			EXPECT_EQ(mask.Count(), 0);
+		}
+	}
+}
@@ -3,6 +3,11 @@
 #include <gtest/gtest.h>
 #include "dynaplex/dynaplexprovider.h"
 #include "dynaplex/torchavailability.h"
+#include "dynaplex/uniformactionselector.h"
+#include "dynaplex/sequentialhalving.h"
+#include "dynaplex/samplegenerator.h"
+#include "dynaplex/sampledata.h"
+#include "dynaplex/threadpool.h"
 namespace DynaPlex::Tests {
 	
 
@@ -134,4 +139,84 @@ namespace DynaPlex::Tests {
 	}
 
 
-}
\ No newline at end of file
+	TEST(DCL, ActionSelectorsOnPool) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+		std::string model_name = "joint_replenishment";
+		auto mdp = dp.GetMDP(VarGroup::LoadFromFile(system.filepath("mdp_config_examples", model_name, "mdp_config_0.json")));
+		auto policy = mdp->GetPolicy(VarGroup::LoadFromFile(system.filepath("mdp_config_examples", model_name, "policy_config_0.json")));
+
+		//find a state with multiple allowed actions.
+		Trajectory root{};
+		root.RNGProvider.SeedEventStreams(true, 4321);
+		mdp->InitiateState({ &root, 1 });
+		while (!mdp->IncorporateUntilNonTrivialAction({ &root, 1 }))
+			;
+		ASSERT_GT(mdp->AllowedActions(root.GetState()).size(), 1);
+
+		auto label = [&](const auto& selector, Trajectory& traj) {
+			DynaPlex::NN::Sample sample{};
+			selector.SetAction(traj, sample, 7);
+			return sample;
+		};
+		auto check = [&](const auto& selector) {
+			Trajectory traj{};
+			traj.RNGProvider.SeedEventStreams(true, 4321);
+			mdp->InitiateState({ &traj, 1 }, root.GetState());
+			auto expected = label(selector, traj);
+
+			//labelling from within tasks on the same pool, such that rollout chunks are nested tasks.
+			std::vector<DynaPlex::NN::Sample> samples(4);
+			system.Pool().Run(4, [&](int64_t i) {
+				Trajectory traj{};
+				traj.RNGProvider.SeedEventStreams(true, 4321);
+				mdp->InitiateState({ &traj, 1 }, root.GetState());
+				samples[i] = label(selector, traj);
+				});
+			for (auto& sample : samples)
+			{
+				EXPECT_EQ(sample.action_label, expected.action_label);
+				EXPECT_EQ(sample.q_hat_vec, expected.q_hat_vec);
+			}
+		};
+		check(DynaPlex::DCL::UniformActionSelector(system, 1122, 10, 20, mdp, policy));
+		check(DynaPlex::DCL::SequentialHalving(system, 1122, 10, 20, mdp, policy));
+	}
+
+	TEST(DCL, StreamedSamples) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+		auto mdp = dp.GetMDP(VarGroup::LoadFromFile(system.filepath("mdp_config_examples", "lost_sales", "mdp_config_0.json")));
+		auto policy = mdp->GetPolicy("base_stock");
+
+		DynaPlex::VarGroup config{ {"N",50},{"M",2},{"H",5},{"L",5},{"silent",true},{"sample_file_format","binary"} };
+		DynaPlex::DCL::SampleGenerator in_memory(system, mdp, config);
+		auto in_memory_path = system.filepath("tests", "dcl_streamed_samples", "in_memory.bin");
+		in_memory.GenerateStateSamples(policy, in_memory_path);
+
+		config.Set("stream_samples", true);
+		//small buffer, such that shards consist of multiple blocks.
+		config.Set("shard_buffer_size", 3);
+		DynaPlex::DCL::SampleGenerator streamed(system, mdp, config);
+		auto streamed_path = system.filepath("tests", "dcl_streamed_samples", "streamed.bin");
+		streamed.GenerateStateSamples(policy, streamed_path);
+
+		auto expected = DynaPlex::NN::SampleData::CreateNewFromFile(mdp, in_memory_path);
+		auto actual = DynaPlex::NN::SampleData::CreateNewFromFile(mdp, streamed_path);
+		ASSERT_EQ(expected.Samples.size(), 50);
+		ASSERT_EQ(actual.Samples.size(), 50);
+		//streamed samples are not shuffled.
+		std::sort(expected.Samples.begin(), expected.Samples.end(), [](const auto& a, const auto& b) { return a.sample_number < b.sample_number; });
+		for (size_t i = 0; i < expected.Samples.size(); i++)
+		{
+			EXPECT_EQ(actual.Samples[i].sample_number, expected.Samples[i].sample_number);
+			EXPECT_EQ(actual.Samples[i].action_label, expected.Samples[i].action_label);
+			EXPECT_EQ(actual.Samples[i].q_hat_vec, expected.Samples[i].q_hat_vec);
+			EXPECT_TRUE(mdp->StatesAreEqual(actual.Samples[i].state, expected.Samples[i].state));
+		}
+
+		config.Set("sample_file_format", "json");
+		EXPECT_THROW(DynaPlex::DCL::SampleGenerator(system, mdp, config), DynaPlex::Error);
+	}
+
+}
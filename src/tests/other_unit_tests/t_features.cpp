@@ -1,6 +1,7 @@
 #include "dynaplex/features.h"
 #include "dynaplex/modelling/queue.h"
 #include <gtest/gtest.h>
+#include <array>
 
 namespace DynaPlex::Tests {
 
@@ -38,6 +39,28 @@ namespace DynaPlex::Tests {
 
     }
     
+    TEST(Features, AddContiguousBlocks) {
+        std::vector<float> storage(9);
+        DynaPlex::Features features(storage);
+
+        const std::vector<int64_t> ints = { 1, -2 };
+        std::vector<double> doubles = { 0.5, 1.5 };
+        std::array<float, 2> floats = { 2.5f, 3.5f };
+        std::vector<bool> bools = { true, false };
+        features.Add(ints);
+        features.Add(doubles);
+        features.Add(floats);
+        features.Add(bools);
+        features.Add(std::span<double>(doubles).subspan(1));
+        EXPECT_TRUE(features.IsFilled());
+        EXPECT_EQ(storage, (std::vector<float>{ 1.0f, -2.0f, 0.5f, 1.5f, 2.5f, 3.5f, 1.0f, 0.0f, 1.5f }));
+
+        //blocks that do not fit are counted, but not written beyond the buffer.
+        features.Add(ints);
+        EXPECT_FALSE(features.IsFilled());
+        EXPECT_EQ(features.NumFeatsAdded(), 11);
+    }
+
     TEST(Features, AddContainer) {
         std::vector<float> storage(10);
         DynaPlex::Features features({ &storage[1],4 });
@@ -0,0 +1,69 @@
+﻿#include "dynaplex/vargroup.h"
+#include "dynaplex/error.h"
+#include <gtest/gtest.h>
+#include "dynaplex/dynaplexprovider.h"
+#include "dynaplex/parametersearch.h"
+
+namespace DynaPlex::Tests {
+
+	TEST(ParameterSearch, CanOrderPolicy) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+		std::string model_name = "joint_replenishment";
+		std::string file_path = system.filepath("mdp_config_examples", model_name, "mdp_config_0.json");
+		auto mdp = dp.GetMDP(VarGroup::LoadFromFile(file_path));
+		std::string policy_file_path = system.filepath("mdp_config_examples", model_name, "policy_config_0.json");
+		auto initial_policy = VarGroup::LoadFromFile(policy_file_path);
+
+		VarGroup config{
+			{"number_of_trajectories", 64},
+			{"periods_per_trajectory", 100},
+			{"max_iterations", 3},
+			{"rng_seed", 1122}
+		};
+		auto search = dp.GetParameterSearch(mdp, config);
+
+		//(s, c, S) must be ordered per SKU.
+		auto is_feasible = [](const VarGroup& policy) {
+			std::vector<int64_t> reorderPoint, canOrderPoint, orderUpToLevel;
+			policy.Get("reorderPoint", reorderPoint);
+			policy.Get("canOrderPoint", canOrderPoint);
+			policy.Get("orderUpToLevel", orderUpToLevel);
+			for (size_t i = 0; i < reorderPoint.size(); i++)
+				if (reorderPoint[i] > canOrderPoint[i] || canOrderPoint[i] >= orderUpToLevel[i])
+					return false;
+			return true;
+		};
+
+		VarGroup result;
+		ASSERT_NO_THROW(
+			result = search.Optimize(initial_policy, { "reorderPoint", "canOrderPoint" }, is_feasible);
+		);
+		int64_t iterations;
+		result.Get("iterations", iterations);
+		EXPECT_LE(iterations, 3);
+
+		VarGroup best_policy;
+		result.Get("policy", best_policy);
+		EXPECT_TRUE(is_feasible(best_policy));
+
+		//starting from a policy that orders far too late, the search must find a policy that is better on trajectories it never saw.
+		auto late = initial_policy;
+		late.Set("reorderPoint", std::vector<int64_t>{ 2, 2, 2, 1 });
+		late.Set("canOrderPoint", std::vector<int64_t>{ 3, 3, 3, 2 });
+		auto late_result = search.Optimize(late, { "reorderPoint", "canOrderPoint" }, is_feasible);
+		VarGroup improved_policy;
+		late_result.Get("policy", improved_policy);
+		auto held_out = dp.GetPolicyComparer(mdp, VarGroup{ {"number_of_trajectories", 256}, {"periods_per_trajectory", 100}, {"rng_seed", 987654} });
+		auto comparison = held_out.Compare(mdp->GetPolicy(late), mdp->GetPolicy(improved_policy), 0);
+		double difference, error;
+		comparison[1].Get("mean", difference);
+		comparison[1].Get("error", error);
+		EXPECT_LT(difference, -3.0 * error);
+
+		//infeasible starting points are rejected.
+		auto infeasible = initial_policy;
+		infeasible.Set("canOrderPoint", std::vector<int64_t>{ 0, 0, 0, 0 });
+		EXPECT_THROW(search.Optimize(infeasible, { "canOrderPoint" }, is_feasible), DynaPlex::Error);
+	}
+}
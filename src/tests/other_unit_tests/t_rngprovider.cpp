@@ -1,6 +1,7 @@
 ﻿#include <gtest/gtest.h>
 #include "dynaplex/rngprovider.h"
 #include "dynaplex/error.h"
+#include "dynaplex/philox.h"
 #include <cmath>
 #include <numeric>
 #include <algorithm>
@@ -56,6 +57,24 @@ namespace DynaPlex::Tests {
 
 	}
 
+	TEST(rngprovider, streams_independent_of_request_order) {
+		DynaPlex::RNGProvider provider{};
+		DynaPlex::RNGProvider provider2{};
+		provider.SeedEventStreams(false, 123, 4, 5);
+		provider2.SeedEventStreams(false, 123, 4, 5);
+
+		//requesting a high stream first only constructs that stream; lower streams are the same as when requested directly.
+		auto& high = provider.GetEventRNG(5);
+		auto& low = provider.GetEventRNG(0);
+		auto& low2 = provider2.GetEventRNG(0);
+		auto reference = DynaPlex::RNG(false, 123, 4, 5, 7);
+		for (size_t i = 0; i < 10; i++)
+		{
+			ASSERT_EQ(low.genUniform(), low2.genUniform());
+			ASSERT_EQ(high.genUniform(), reference.genUniform());
+		}
+	}
+
 	// Helper function to calculate the ECDF
 	std::vector<double> ecdf(const std::vector<double>& data) {
 		std::vector<double> sorted_data = data;
@@ -210,4 +229,74 @@ namespace DynaPlex::Tests {
 	}
 
 
+	TEST(rng, discard) {
+		auto rng = DynaPlex::RNG(false, 123, 5, 6, 7);
+		auto rng2 = DynaPlex::RNG(false, 123, 5, 6, 7);
+		for (uint64_t skip : { 0, 1, 2, 5 })
+		{
+			for (uint64_t i = 0; i < skip; i++)
+				rng.genInt();
+			rng2.Discard(skip);
+			ASSERT_EQ(rng.genInt(), rng2.genInt());
+		}
+	}
+
+	TEST(rng, bulk) {
+		auto rng = DynaPlex::RNG(false, 123, 5, 6, 7);
+		auto rng2 = DynaPlex::RNG(false, 123, 5, 6, 7);
+		std::vector<double> uniforms(13);
+		std::vector<int64_t> ints(7);
+		rng.genUniforms(uniforms);
+		rng.genInts(ints);
+		for (double uniform : uniforms)
+			ASSERT_EQ(uniform, rng2.genUniform());
+		for (int64_t value : ints)
+			ASSERT_EQ(value, rng2.genInt());
+		//the stream continues after the bulk draws.
+		ASSERT_EQ(rng.genInt(), rng2.genInt());
+	}
+
+	TEST(philox, known_answers) {
+		//test vectors of the reference implementation (Random123).
+		using block = DynaPlex::Philox4x32::block_type;
+		EXPECT_EQ(DynaPlex::Philox4x32::Block({ 0, 0, 0, 0 }, { 0, 0 }), (block{ 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 }));
+		EXPECT_EQ(DynaPlex::Philox4x32::Block({ 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff }, { 0xffffffff, 0xffffffff }), (block{ 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd }));
+		EXPECT_EQ(DynaPlex::Philox4x32::Block({ 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 }, { 0xa4093822, 0x299f31d0 }), (block{ 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 }));
+	}
+
+	TEST(philox, discard) {
+		DynaPlex::Philox4x32 gen(123), gen2(123);
+		for (uint64_t skip : { 0, 1, 2, 3, 1000 })
+		{
+			for (uint64_t i = 0; i < skip; i++)
+				gen();
+			gen2.discard(skip);
+			ASSERT_EQ(gen(), gen2());
+		}
+	}
+
+	TEST(philox, iid_uniformity) {
+		//first numbers from seeds as combined by DynaPlex::RNG for adjacent streams.
+		int number_of_samples = 150;
+		auto uniformity_failures = 0;
+		auto independence_failures = 0;
+		auto tries = 1000;
+		auto significance = 0.1;
+		for (uint64_t i = 0; i < tries; i++)
+		{
+			std::vector<double> first_drawn_numbers;
+			first_drawn_numbers.reserve(number_of_samples);
+			for (uint64_t stream = 0; stream < number_of_samples; ++stream) {
+				DynaPlex::Philox4x32 gen(((123ull << 33) | (i << 10) | stream) ^ 123123ull);
+				first_drawn_numbers.push_back(XoshiroCpp::DoubleFromBits(gen()));
+			}
+			if (!isUniform(first_drawn_numbers, significance))
+				uniformity_failures++;
+			if (!isIndependent(first_drawn_numbers, significance, 0.4))
+				independence_failures++;
+		}
+		EXPECT_NEAR(significance * tries, uniformity_failures, 0.03 * tries);
+		EXPECT_NEAR(significance * tries, independence_failures, 0.03 * tries);
+	}
+
 }
\ No newline at end of file
@@ -0,0 +1,79 @@
+﻿#include "dynaplex/vargroup.h"
+#include "dynaplex/error.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "dynaplex/dynaplexprovider.h"
+
+namespace DynaPlex::Tests {
+
+	namespace {
+		//forwards to another policy, but hides its type, such that MDP->Rollout cannot use the typed kernel.
+		class ForwardingPolicy : public PolicyInterface {
+			DynaPlex::Policy policy;
+		public:
+			ForwardingPolicy(DynaPlex::Policy policy) : policy{ policy } {}
+			std::string TypeIdentifier() const override { return policy->TypeIdentifier(); }
+			const DynaPlex::VarGroup& GetConfig() const override { return policy->GetConfig(); }
+			void SetAction(std::span<Trajectory> trajectories) const override { policy->SetAction(trajectories); }
+		};
+
+		std::vector<Trajectory> GetTrajectories(DynaPlex::MDP& mdp, int64_t number)
+		{
+			std::vector<Trajectory> trajectories;
+			for (int64_t i = 0; i < number; i++)
+			{
+				trajectories.emplace_back(i);
+				trajectories.back().RNGProvider.SeedEventStreams(true, 2711, i);
+			}
+			mdp->InitiateState(trajectories);
+			return trajectories;
+		}
+	}
+
+	TEST(Rollout, MatchesIncorporateLoop) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+		std::string model_name = "joint_replenishment";
+		std::string file_path = system.filepath("mdp_config_examples", model_name, "mdp_config_0.json");
+		auto mdp = dp.GetMDP(VarGroup::LoadFromFile(file_path));
+		std::string policy_file_path = system.filepath("mdp_config_examples", model_name, "policy_config_0.json");
+		auto policy = mdp->GetPolicy(VarGroup::LoadFromFile(policy_file_path));
+
+		int64_t number = 16, max_periods = 50;
+		auto expected = GetTrajectories(mdp, number);
+		for (auto& traj : expected)
+		{
+			std::span<Trajectory> single{ &traj, 1 };
+			while (mdp->IncorporateUntilAction(single, max_periods))
+				mdp->IncorporateAction(single, policy);
+		}
+
+		auto typed = GetTrajectories(mdp, number);
+		mdp->Rollout(typed, policy, max_periods);
+
+		auto batched = GetTrajectories(mdp, number);
+		DynaPlex::Policy forwarding = std::make_shared<ForwardingPolicy>(policy);
+		mdp->Rollout(batched, forwarding, max_periods);
+		std::sort(batched.begin(), batched.end(), [](const Trajectory& a, const Trajectory& b) {return a.ExternalIndex < b.ExternalIndex; });
+
+		for (int64_t i = 0; i < number; i++)
+		{
+			EXPECT_EQ(typed[i].ExternalIndex, i);
+			EXPECT_EQ(typed[i].PeriodCount, max_periods);
+			EXPECT_DOUBLE_EQ(typed[i].CumulativeReturn, expected[i].CumulativeReturn);
+			EXPECT_TRUE(mdp->StatesAreEqual(typed[i].GetState(), expected[i].GetState()));
+			EXPECT_DOUBLE_EQ(batched[i].CumulativeReturn, expected[i].CumulativeReturn);
+			EXPECT_TRUE(mdp->StatesAreEqual(batched[i].GetState(), expected[i].GetState()));
+		}
+	}
+
+	TEST(Rollout, RejectsPolicyOfOtherMDP) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+		auto mdp = dp.GetMDP(VarGroup::LoadFromFile(system.filepath("mdp_config_examples", "joint_replenishment", "mdp_config_0.json")));
+		auto other_mdp = dp.GetMDP(VarGroup::LoadFromFile(system.filepath("mdp_config_examples", "joint_replenishment", "mdp_config_1.json")));
+
+		auto trajectories = GetTrajectories(mdp, 2);
+		EXPECT_THROW(mdp->Rollout(trajectories, other_mdp->GetPolicy("random"), 10), DynaPlex::Error);
+	}
+}
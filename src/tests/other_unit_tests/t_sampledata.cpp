@@ -1,6 +1,7 @@
 ﻿#include "dynaplex/vargroup.h"
 #include "dynaplex/error.h"
 #include <gtest/gtest.h>
+#include <cstring>
 #include "dynaplex/dynaplexprovider.h"
 #include "dynaplex/trajectory.h"
 #include "dynaplex/demonstrator.h"
@@ -71,4 +72,108 @@ namespace DynaPlex::Tests {
 		//lost_sales starts with action, and alternates between actions and events, never final. Hence, there will be 2*maxevents elements in trace. 
 		ASSERT_EQ(trace.size(), max_periods *2);
 	}
+	TEST(sampledata, binary) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+
+		std::string file_path = system.filepath("mdp_config_examples", "lost_sales", "mdp_config_0.json");
+		auto mdp = dp.GetMDP(VarGroup::LoadFromFile(file_path));
+
+		auto demonstrator = dp.GetDemonstrator(DynaPlex::VarGroup{ {"max_period_count", 10},{"seed",123} });
+		auto trace = demonstrator.GetObjectTrace(mdp);
+		DynaPlex::NN::SampleData data{ mdp };
+		for (auto& elem : trace)
+		{
+			if (elem.cat.IsAwaitAction())
+			{
+				auto& sample = data.Samples.emplace_back(elem.action, elem.state->Clone());
+				sample.sample_number = static_cast<int64_t>(data.Samples.size());
+				sample.q_hat = 0.5 * elem.action;
+				sample.z_stat = 0.0;
+				sample.q_hat_vec = std::vector<double>(elem.action + 1, 1.25);
+			}
+		}
+		std::string path = system.filepath("tests", "sampledata_binary", "data.bin");
+		data.SaveToBinaryFile(mdp, path);
+
+		//format is detected from the file contents:
+		auto data_from_binary = DynaPlex::NN::SampleData::CreateNewFromFile(mdp, path);
+		ASSERT_EQ(data.Samples.size(), data_from_binary.Samples.size());
+		for (size_t i = 0; i < data.Samples.size(); i++)
+		{
+			auto& sample = data.Samples[i];
+			auto& other = data_from_binary.Samples[i];
+			ASSERT_EQ(sample.action_label, other.action_label);
+			ASSERT_EQ(sample.sample_number, other.sample_number);
+			ASSERT_EQ(sample.q_hat, other.q_hat);
+			ASSERT_EQ(sample.q_hat_vec, other.q_hat_vec);
+			ASSERT_TRUE(other.cost_improvement.empty());
+			ASSERT_TRUE(mdp->StatesAreEqual(sample.state, other.state));
+			//features and masks are restored from the file.
+			std::vector<float> features(mdp->NumFlatFeatures());
+			mdp->GetFlatFeatures(sample.state, features);
+			ASSERT_EQ(features, other.features);
+			ASSERT_EQ(other.allowed_actions_mask.size(), mdp->NumValidActions());
+			for (int64_t action = 0; action < mdp->NumValidActions(); action++)
+				ASSERT_EQ(other.allowed_actions_mask[action] == 1, mdp->IsAllowedAction(sample.state, action));
+		}
+
+		data_from_binary.AddFromFile(mdp, path);
+		ASSERT_EQ(2 * data.Samples.size(), data_from_binary.Samples.size());
+
+		//in-memory encoding, as used to gather samples over MPI; blocks can be concatenated.
+		auto bytes = data.ToBinary(mdp);
+		auto block = bytes;
+		bytes.insert(bytes.end(), block.begin(), block.end());
+		DynaPlex::NN::SampleData data_from_bytes{ mdp };
+		data_from_bytes.AddFromBinary(mdp, bytes);
+		ASSERT_EQ(2 * data.Samples.size(), data_from_bytes.Samples.size());
+		for (size_t i = 0; i < data_from_bytes.Samples.size(); i++)
+		{
+			auto& sample = data.Samples[i % data.Samples.size()];
+			ASSERT_EQ(sample.action_label, data_from_bytes.Samples[i].action_label);
+			ASSERT_TRUE(mdp->StatesAreEqual(sample.state, data_from_bytes.Samples[i].state));
+		}
+
+		auto other_mdp = dp.GetMDP(VarGroup::LoadFromFile(system.filepath("mdp_config_examples", "lost_sales", "mdp_config_1.json")));
+		EXPECT_THROW(DynaPlex::NN::SampleData::CreateNewFromFile(other_mdp, path), DynaPlex::Error);
+	}
+
+	TEST(sampledata, binary_corrupt) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+
+		std::string file_path = system.filepath("mdp_config_examples", "lost_sales", "mdp_config_0.json");
+		auto mdp = dp.GetMDP(VarGroup::LoadFromFile(file_path));
+
+		auto demonstrator = dp.GetDemonstrator(DynaPlex::VarGroup{ {"max_period_count", 10},{"seed",123} });
+		auto trace = demonstrator.GetObjectTrace(mdp);
+		DynaPlex::NN::SampleData data{ mdp };
+		for (auto& elem : trace)
+			if (elem.cat.IsAwaitAction())
+				data.Samples.emplace_back(elem.action, elem.state->Clone());
+		auto bytes = data.ToBinary(mdp);
+
+		//truncated data:
+		for (size_t size : { bytes.size() - 1, bytes.size() / 2, size_t{ 20 } })
+		{
+			DynaPlex::NN::SampleData truncated{ mdp };
+			EXPECT_THROW(truncated.AddFromBinary(mdp, std::span<const uint8_t>(bytes.data(), size)), DynaPlex::Error);
+		}
+
+		//the number of samples follows the magic, version and identifier:
+		size_t num_samples_position = 8 + sizeof(uint32_t) + sizeof(uint64_t) + mdp->Identifier().size();
+		auto corrupt = bytes;
+		uint64_t huge = uint64_t{ 1 } << 60;
+		std::memcpy(corrupt.data() + num_samples_position, &huge, sizeof(huge));
+		DynaPlex::NN::SampleData from_corrupt{ mdp };
+		EXPECT_THROW(from_corrupt.AddFromBinary(mdp, corrupt), DynaPlex::Error);
+
+		//number of features that does not match the mdp:
+		corrupt = bytes;
+		int64_t num_features = mdp->NumFlatFeatures() + 1;
+		std::memcpy(corrupt.data() + num_samples_position + sizeof(uint64_t), &num_features, sizeof(num_features));
+		EXPECT_THROW(from_corrupt.AddFromBinary(mdp, corrupt), DynaPlex::Error);
+		EXPECT_TRUE(from_corrupt.Samples.empty());
+	}
 }
\ No newline at end of file
@@ -0,0 +1,75 @@
+﻿#include "dynaplex/vargroup.h"
+#include "dynaplex/error.h"
+#include <gtest/gtest.h>
+#include "dynaplex/dynaplexprovider.h"
+#include "dynaplex/statepool.h"
+
+namespace DynaPlex::Tests {
+
+	TEST(StatePool, ReusesStates) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+		std::string file_path = system.filepath("mdp_config_examples", "joint_replenishment", "mdp_config_0.json");
+		auto mdp = dp.GetMDP(VarGroup::LoadFromFile(file_path));
+		auto policy = mdp->GetPolicy("random");
+
+		std::vector<Trajectory> trajectories(4);
+		mdp->InitiateState(trajectories);
+		auto root_state = trajectories[0].GetState()->Clone();
+
+		//advance the trajectories, such that pooled states differ from the root state.
+		for (auto& traj : trajectories)
+			traj.RNGProvider.SeedEventStreams(true, 1234);
+		for (int64_t i = 0; i < 10; i++)
+		{
+			mdp->IncorporateUntilAction(trajectories);
+			mdp->IncorporateAction(trajectories, policy);
+		}
+
+		std::vector<const StateBase*> addresses;
+		for (auto& traj : trajectories)
+			addresses.push_back(traj.GetState().get());
+
+		StatePool pool{};
+		pool.Return(trajectories);
+		EXPECT_EQ(pool.Size(), 4);
+		for (auto& traj : trajectories)
+			EXPECT_FALSE(traj.HasState());
+
+		pool.Lend(trajectories);
+		EXPECT_EQ(pool.Size(), 0);
+		mdp->InitiateState(trajectories, root_state);
+		for (auto& traj : trajectories)
+		{
+			//the pooled state is reused, and holds a copy of the root state.
+			EXPECT_NE(std::find(addresses.begin(), addresses.end(), traj.GetState().get()), addresses.end());
+			EXPECT_TRUE(mdp->StatesAreEqual(traj.GetState(), root_state));
+			EXPECT_EQ(traj.PeriodCount, 0);
+		}
+	}
+
+	TEST(StatePool, BoundedAndKeyedByMDP) {
+		auto& dp = DynaPlexProvider::Get();
+		auto& system = dp.System();
+		std::string file_path = system.filepath("mdp_config_examples", "joint_replenishment", "mdp_config_0.json");
+		auto mdp = dp.GetMDP(VarGroup::LoadFromFile(file_path));
+		auto other_mdp = dp.GetMDP(VarGroup::LoadFromFile(file_path));
+
+		std::vector<Trajectory> trajectories(4);
+		mdp->InitiateState(trajectories);
+		StatePool pool{ 3 };
+		pool.Return(trajectories);
+		//states beyond the capacity are released, not kept.
+		EXPECT_EQ(pool.Size(), 3);
+		for (auto& traj : trajectories)
+			EXPECT_FALSE(traj.HasState());
+
+		mdp->InitiateState(trajectories);
+		auto& thread_pool = StatePool::ForThread(mdp);
+		thread_pool.Return(trajectories);
+		EXPECT_EQ(StatePool::ForThread(mdp).Size(), 4);
+		//requesting the pool for another mdp discards the states of the previous one.
+		EXPECT_EQ(StatePool::ForThread(other_mdp).Size(), 0);
+		EXPECT_EQ(&StatePool::ForThread(other_mdp), &thread_pool);
+	}
+}
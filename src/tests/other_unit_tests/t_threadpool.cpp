@@ -0,0 +1,70 @@
+﻿#include "dynaplex/vargroup.h"
+#include "dynaplex/error.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include "dynaplex/dynaplexprovider.h"
+#include "dynaplex/threadpool.h"
+#include "dynaplex/parallel_execute.h"
+
+namespace DynaPlex::Tests {
+
+	TEST(ThreadPool, RunsAllTasks) {
+		DynaPlex::Parallel::ThreadPool pool(4);
+		std::vector<std::atomic<int64_t>> executed(1000);
+		//tasks of unequal duration, such that stealing occurs.
+		pool.Run(1000, [&executed](int64_t i) {
+			if (i < 10)
+				std::this_thread::sleep_for(std::chrono::milliseconds(5));
+			executed[i]++;
+			});
+		for (auto& count : executed)
+			EXPECT_EQ(count.load(), 1);
+	}
+
+	TEST(ThreadPool, Nested) {
+		DynaPlex::Parallel::ThreadPool pool(2);
+		std::atomic<int64_t> total = 0;
+		//more outer tasks than workers, each waiting on an inner batch.
+		pool.Run(8, [&pool, &total](int64_t) {
+			pool.Run(16, [&total](int64_t j) { total += j; });
+			});
+		EXPECT_EQ(total.load(), 8 * (15 * 16 / 2));
+	}
+
+	TEST(ThreadPool, Exceptions) {
+		DynaPlex::Parallel::ThreadPool pool(3);
+		std::atomic<int64_t> executed = 0;
+		EXPECT_THROW(pool.Run(10000, [&executed](int64_t i) {
+			if (i == 0)
+				throw DynaPlex::Error("failure in task");
+			executed++;
+			}), DynaPlex::Error);
+		//the pool remains usable:
+		executed = 0;
+		pool.Run(10, [&executed](int64_t) { executed++; });
+		EXPECT_EQ(executed.load(), 10);
+	}
+
+	TEST(ThreadPool, ParallelCompute) {
+		auto& dp = DynaPlexProvider::Get();
+		std::vector<int64_t> data(12345, -1);
+		DynaPlex::Parallel::parallel_compute<int64_t>(dp.System(), data, [](std::span<int64_t> span, int64_t offset) {
+			for (size_t i = 0; i < span.size(); i++)
+				span[i] = offset + static_cast<int64_t>(i);
+			});
+		for (size_t i = 0; i < data.size(); i++)
+			ASSERT_EQ(data[i], static_cast<int64_t>(i));
+
+		//progress reporter runs on the calling thread, and learns about errors through the flag.
+		bool reporter_called = false;
+		EXPECT_THROW(DynaPlex::Parallel::parallel_compute<int64_t>(dp.System(), data, [](std::span<int64_t>, int64_t) {
+			throw DynaPlex::Error("failure in work");
+			}, [&reporter_called](const std::atomic<bool>& error_occurred) {
+				while (!error_occurred)
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				reporter_called = true;
+			}), DynaPlex::Error);
+		EXPECT_TRUE(reporter_called);
+	}
+}